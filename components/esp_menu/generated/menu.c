@@ -1,318 +1,218 @@
 // Generated menu.c from template
-// Includes required LVGL and user graphics headers
+// Const menu tree walked by the esp_menu runtime engine (see esp_menu_engine.h)
 #include "lvgl.h"
+#include "esp_menu_direct.h"
+#include "esp_menu_engine.h"
+#include "esp_menu_param.h"
 #include "menu_data.h"
 #include "user_graphic.h"
-#include <string.h>
-
-// Helper macro to sanitize names into valid C identifiers
-// Jinja macro: replaces spaces, slashes, hyphens and '&' then lowers
-
-
-// Forward declarations for submenu screens so event handlers can switch screens
-
-
-
-
-
-
-
-static lv_obj_t *scr_waveform;
-
-
-
-static lv_obj_t *scr_level_fine;
-
-
-
-static lv_obj_t *scr_pw_ampmod;
-
-
-
-static lv_obj_t *scr_favorites;
-
-
-
 
 // Declarations for embedded images provided via graphics_code
 
-
 // Image graphic: pitch_icon
 LV_IMG_DECLARE(pitch_icon_dsc);
 
 
-
 // Image graphic: waveform_icon
 LV_IMG_DECLARE(waveform_icon_dsc);
 
 
-
 // Image graphic: next_icon
 LV_IMG_DECLARE(next_icon_dsc);
 
 
-
 // Image graphic: prev_icon
 LV_IMG_DECLARE(prev_icon_dsc);
 
 
-
-static void event_handler(lv_event_t *e) {
-    lv_obj_t *obj = lv_event_get_target(e);
-    if (lv_event_get_code(e) != LV_EVENT_CLICKED) return;
-    const char *text = lv_list_get_btn_text(lv_obj_get_parent(obj), obj);
-    if (!text) return;
-    
-    
-    if (strcmp(text, "Pitch Up") == 0) {
-        
-        pitch_up();
-        
-        return;
-    }
-    
-    if (strcmp(text, "Pitch Down") == 0) {
-        
-        pitch_down();
-        
-        return;
-    }
-    
-    if (strcmp(text, "Waveform") == 0) {
-        
-        lv_scr_load(scr_waveform);
-        
-        return;
-    }
-    
-    if (strcmp(text, "Level/Fine") == 0) {
-        
-        lv_scr_load(scr_level_fine);
-        
-        return;
-    }
-    
-    if (strcmp(text, "PW/AmpMod") == 0) {
-        
-        lv_scr_load(scr_pw_ampmod);
-        
-        return;
-    }
-    
-    if (strcmp(text, "Favorites") == 0) {
-        
-        lv_scr_load(scr_favorites);
-        
-        return;
-    }
-    
-    
-}
+// Item table, indexed by menu_item_id_t
+static const esp_menu_item_desc_t s_menu_items[MENU_ITEM_COUNT] = {
+    [MENU_ITEM_MAIN_PITCH] = { "Pitch", &pitch_icon_dsc, NULL, ESP_MENU_NO_SCREEN, MENU_PARAM_PITCH, ESP_MENU_ITEM_PARAM },
+    [MENU_ITEM_MAIN_WAVEFORM] = { "Waveform", &waveform_icon_dsc, NULL, ESP_MENU_NO_SCREEN, MENU_PARAM_WAVEFORM, ESP_MENU_ITEM_PARAM },
+    [MENU_ITEM_MAIN_LEVEL_FINE] = { "Level/Fine", NULL, NULL, MENU_SCREEN_LEVEL_FINE, ESP_MENU_NO_PARAM, ESP_MENU_ITEM_SUBMENU },
+    [MENU_ITEM_MAIN_PW_AMPMOD] = { "PW/AmpMod", NULL, NULL, MENU_SCREEN_PW_AMPMOD, ESP_MENU_NO_PARAM, ESP_MENU_ITEM_SUBMENU },
+    [MENU_ITEM_MAIN_FAVORITES] = { "Favorites", NULL, NULL, MENU_SCREEN_FAVORITES, ESP_MENU_NO_PARAM, ESP_MENU_ITEM_SUBMENU },
+    [MENU_ITEM_MAIN_PRESETS] = { "Presets", NULL, NULL, MENU_SCREEN_PRESETS, ESP_MENU_NO_PARAM, ESP_MENU_ITEM_SUBMENU },
+    [MENU_ITEM_LEVEL_FINE_LEVEL] = { "Level", NULL, NULL, ESP_MENU_NO_SCREEN, MENU_PARAM_LEVEL, ESP_MENU_ITEM_PARAM },
+    [MENU_ITEM_LEVEL_FINE_FINE_TUNE] = { "Fine Tune", NULL, NULL, ESP_MENU_NO_SCREEN, MENU_PARAM_FINE_TUNE, ESP_MENU_ITEM_PARAM },
+    [MENU_ITEM_PW_AMPMOD_PULSE_WIDTH] = { "Pulse Width", NULL, NULL, ESP_MENU_NO_SCREEN, MENU_PARAM_PULSE_WIDTH, ESP_MENU_ITEM_PARAM },
+    [MENU_ITEM_PW_AMPMOD_AMP_MOD_SLOT] = { "Amp Mod Slot", NULL, NULL, ESP_MENU_NO_SCREEN, MENU_PARAM_AMP_MOD_SLOT, ESP_MENU_ITEM_PARAM },
+    [MENU_ITEM_FAVORITES_SELECT_NEXT] = { "Select Next", NULL, select_favorite_slot_next, ESP_MENU_NO_SCREEN, ESP_MENU_NO_PARAM, ESP_MENU_ITEM_ACTION },
+    [MENU_ITEM_FAVORITES_SELECT_PREV] = { "Select Prev", NULL, select_favorite_slot_prev, ESP_MENU_NO_SCREEN, ESP_MENU_NO_PARAM, ESP_MENU_ITEM_ACTION },
+    [MENU_ITEM_FAVORITES_SAVE] = { "Save", NULL, save_favorite_action, ESP_MENU_NO_SCREEN, ESP_MENU_NO_PARAM, ESP_MENU_ITEM_ACTION },
+    [MENU_ITEM_FAVORITES_LOAD] = { "Load", NULL, load_favorite_action, ESP_MENU_NO_SCREEN, ESP_MENU_NO_PARAM, ESP_MENU_ITEM_ACTION },
+    [MENU_ITEM_FAVORITES_CLEAR] = { "Clear", NULL, clear_favorite_action, ESP_MENU_NO_SCREEN, ESP_MENU_NO_PARAM, ESP_MENU_ITEM_ACTION },
+    [MENU_ITEM_PRESETS_LOAD_PRESET] = { "Load Preset", NULL, preset_load_action, ESP_MENU_NO_SCREEN, ESP_MENU_NO_PARAM, ESP_MENU_ITEM_ACTION },
+    [MENU_ITEM_PRESETS_SAVE_PRESET] = { "Save Preset", NULL, preset_save_action, ESP_MENU_NO_SCREEN, ESP_MENU_NO_PARAM, ESP_MENU_ITEM_ACTION },
+};
+
+// Screen table, indexed by menu_screen_id_t; each screen owns a contiguous item range
+static const esp_menu_screen_desc_t s_menu_screens[MENU_SCREEN_COUNT] = {
+    [MENU_SCREEN_MAIN] = { "main", 0, 6 },
+    [MENU_SCREEN_LEVEL_FINE] = { "Level/Fine", 6, 2 },
+    [MENU_SCREEN_PW_AMPMOD] = { "PW/AmpMod", 8, 2 },
+    [MENU_SCREEN_FAVORITES] = { "Favorites", 10, 5 },
+    [MENU_SCREEN_PRESETS] = { "Presets", 15, 2 },
+};
+
+static const char *const s_param_waveform_options[] = { "Sine", "Triangle", "Saw", "Square", "Pulse" };
+
+// Parameter descriptors, indexed by menu_param_id_t
+static const esp_menu_param_desc_t s_menu_param_descs[MENU_PARAM_COUNT ? MENU_PARAM_COUNT : 1] = {
+    [MENU_PARAM_PITCH] = {
+        .label = "Pitch",
+        .nvs_key = "freq_pitch",
+        .format = NULL,
+        .options = NULL,
+        .on_change = NULL,
+        .min = 0,
+        .max = 127,
+        .step = 1,
+        .def = 69,
+        .accel_max = 0,
+        .type = ESP_MENU_PARAM_U8,
+        .flags = 0,
+        .accel = ESP_MENU_ACCEL_QUADRATIC,
+    },
+    [MENU_PARAM_FINE_TUNE] = {
+        .label = "Fine",
+        .nvs_key = "freq_fine",
+        .format = "%+d",
+        .options = NULL,
+        .on_change = NULL,
+        .min = -100,
+        .max = 100,
+        .step = 1,
+        .def = 0,
+        .accel_max = 0,
+        .type = ESP_MENU_PARAM_I16,
+        .flags = 0,
+        .accel = ESP_MENU_ACCEL_QUADRATIC,
+    },
+    [MENU_PARAM_WAVEFORM] = {
+        .label = "Wave",
+        .nvs_key = "waveform",
+        .format = NULL,
+        .options = s_param_waveform_options,
+        .on_change = NULL,
+        .min = 0,
+        .max = 4,
+        .step = 1,
+        .def = 0,
+        .accel_max = 0,
+        .type = ESP_MENU_PARAM_ENUM,
+        .flags = ESP_MENU_PARAM_FLAG_WRAP,
+        .accel = ESP_MENU_ACCEL_NONE,
+    },
+    [MENU_PARAM_LEVEL] = {
+        .label = "Level",
+        .nvs_key = "level",
+        .format = NULL,
+        .options = NULL,
+        .on_change = NULL,
+        .min = 0,
+        .max = 65535,
+        .step = 655,
+        .def = 65535,
+        .accel_max = 0,
+        .type = ESP_MENU_PARAM_U16,
+        .flags = 0,
+        .accel = ESP_MENU_ACCEL_QUADRATIC,
+    },
+    [MENU_PARAM_PULSE_WIDTH] = {
+        .label = "PW",
+        .nvs_key = "pulse_width",
+        .format = NULL,
+        .options = NULL,
+        .on_change = NULL,
+        .min = 0,
+        .max = 65535,
+        .step = 655,
+        .def = 32768,
+        .accel_max = 0,
+        .type = ESP_MENU_PARAM_U16,
+        .flags = 0,
+        .accel = ESP_MENU_ACCEL_QUADRATIC,
+    },
+    [MENU_PARAM_AMP_MOD_SLOT] = {
+        .label = "AM Slot",
+        .nvs_key = "amp_mod_slot",
+        .format = NULL,
+        .options = NULL,
+        .on_change = NULL,
+        .min = -1,
+        .max = 15,
+        .step = 1,
+        .def = -1,
+        .accel_max = 0,
+        .type = ESP_MENU_PARAM_I8,
+        .flags = ESP_MENU_PARAM_FLAG_WRAP,
+        .accel = ESP_MENU_ACCEL_QUADRATIC,
+    },
+    [MENU_PARAM_FREQ_MOD_SLOT] = {
+        .label = "FM Slot",
+        .nvs_key = "freq_mod_slot",
+        .format = NULL,
+        .options = NULL,
+        .on_change = NULL,
+        .min = -1,
+        .max = 15,
+        .step = 1,
+        .def = -1,
+        .accel_max = 0,
+        .type = ESP_MENU_PARAM_I8,
+        .flags = ESP_MENU_PARAM_FLAG_WRAP,
+        .accel = ESP_MENU_ACCEL_QUADRATIC,
+    },
+    [MENU_PARAM_SYNC_SLOT] = {
+        .label = "Sync Slot",
+        .nvs_key = "sync_slot",
+        .format = NULL,
+        .options = NULL,
+        .on_change = NULL,
+        .min = -1,
+        .max = 15,
+        .step = 1,
+        .def = -1,
+        .accel_max = 0,
+        .type = ESP_MENU_PARAM_I8,
+        .flags = ESP_MENU_PARAM_FLAG_WRAP,
+        .accel = ESP_MENU_ACCEL_QUADRATIC,
+    },
+};
+
+// Current parameter values, loaded from the defaults above at start
+static int32_t s_menu_param_values[MENU_PARAM_COUNT ? MENU_PARAM_COUNT : 1];
+
+static const esp_menu_param_table_t s_menu_params = {
+    .descs = s_menu_param_descs,
+    .values = s_menu_param_values,
+    .count = MENU_PARAM_COUNT,
+};
+
+// Bindings of the direct-control encoders 2-4
+static const uint16_t s_menu_direct_params[ESP_MENU_DIRECT_MAX] = {
+    MENU_PARAM_PITCH,
+    ESP_MENU_DIRECT_FOLLOW,
+    ESP_MENU_DIRECT_FOLLOW,
+};
+
+// Navigation stack, sized at generation time for the deepest submenu chain
+static esp_menu_nav_frame_t s_menu_nav_stack[MENU_MAX_DEPTH];
+
+static const esp_menu_tree_t s_menu_tree = {
+    .screens = s_menu_screens,
+    .items = s_menu_items,
+    .screen_count = MENU_SCREEN_COUNT,
+    .item_count = MENU_ITEM_COUNT,
+    .nav_stack = s_menu_nav_stack,
+    .max_depth = MENU_MAX_DEPTH,
+    .params = &s_menu_params,
+    .direct_params = s_menu_direct_params,
+    .direct_count = ESP_MENU_DIRECT_MAX,
+    .screen_init = user_graphic_init,
+};
 
 void menu_init(void) {
-    // Create main screen and any submenu screens
-    lv_obj_t *scr_main = lv_obj_create(NULL);
-    user_graphic_init(scr_main);
-    
-    
-    
-    
-    
-    
-    
-    scr_waveform = lv_obj_create(NULL);
-    user_graphic_init(scr_waveform);
-    
-    
-    
-    scr_level_fine = lv_obj_create(NULL);
-    user_graphic_init(scr_level_fine);
-    
-    
-    
-    scr_pw_ampmod = lv_obj_create(NULL);
-    user_graphic_init(scr_pw_ampmod);
-    
-    
-    
-    scr_favorites = lv_obj_create(NULL);
-    user_graphic_init(scr_favorites);
-    
-    
-    
-
-    // Styles for better focus visibility and spacing on monochrome OLED
-    static lv_style_t style_focus;
-    static lv_style_t style_normal;
-    lv_style_init(&style_focus);
-    lv_style_set_bg_opa(&style_focus, LV_OPA_COVER);
-    lv_style_set_bg_color(&style_focus, lv_color_white());
-    lv_style_set_text_color(&style_focus, lv_color_black());
-    lv_style_set_border_width(&style_focus, 2);
-    lv_style_set_border_color(&style_focus, lv_color_black());
-    lv_style_set_outline_width(&style_focus, 1);
-    lv_style_set_outline_color(&style_focus, lv_color_black());
-    lv_style_set_pad_all(&style_focus, 2);
-
-    lv_style_init(&style_normal);
-    lv_style_set_pad_all(&style_normal, 1);
-    lv_style_set_min_height(&style_normal, 14);
-
-    // Build main menu list
-    lv_obj_t *list_main = lv_list_create(scr_main);
-    lv_obj_center(list_main);
-    lv_obj_add_style(list_main, &style_focus, LV_PART_ITEMS | LV_STATE_FOCUSED);
-    lv_obj_add_style(list_main, &style_normal, LV_PART_ITEMS);
-    
-    
-    
-    lv_obj_t *btn_main_0 = lv_list_add_btn(list_main, &pitch_icon_dsc, "Pitch Up");
-    
-    lv_obj_add_event_cb(btn_main_0, event_handler, LV_EVENT_CLICKED, NULL);
-    
-    
-    lv_obj_t *btn_main_1 = lv_list_add_btn(list_main, &pitch_icon_dsc, "Pitch Down");
-    
-    lv_obj_add_event_cb(btn_main_1, event_handler, LV_EVENT_CLICKED, NULL);
-    
-    
-    lv_obj_t *btn_main_2 = lv_list_add_btn(list_main, &waveform_icon_dsc, "Waveform");
-    
-    lv_obj_add_event_cb(btn_main_2, event_handler, LV_EVENT_CLICKED, NULL);
-    
-    
-    lv_obj_t *btn_main_3 = lv_list_add_btn(list_main, NULL, "Level/Fine");
-    
-    lv_obj_add_event_cb(btn_main_3, event_handler, LV_EVENT_CLICKED, NULL);
-    
-    
-    lv_obj_t *btn_main_4 = lv_list_add_btn(list_main, NULL, "PW/AmpMod");
-    
-    lv_obj_add_event_cb(btn_main_4, event_handler, LV_EVENT_CLICKED, NULL);
-    
-    
-    lv_obj_t *btn_main_5 = lv_list_add_btn(list_main, NULL, "Favorites");
-    
-    lv_obj_add_event_cb(btn_main_5, event_handler, LV_EVENT_CLICKED, NULL);
-    
-    
-
-    // Build submenu lists
-    
-    
-    
-    
-    
-    
-    
-    lv_obj_t *list_waveform = lv_list_create(scr_waveform);
-    lv_obj_center(list_waveform);
-    lv_obj_add_style(list_waveform, &style_focus, LV_PART_ITEMS | LV_STATE_FOCUSED);
-    lv_obj_add_style(list_waveform, &style_normal, LV_PART_ITEMS);
-        
-        
-        lv_obj_t *btn_waveform_0 = lv_list_add_btn(list_waveform, &next_icon_dsc, "Next");
-        
-        lv_obj_add_event_cb(btn_waveform_0, event_handler, LV_EVENT_CLICKED, NULL);
-        
-        
-        lv_obj_t *btn_waveform_1 = lv_list_add_btn(list_waveform, &prev_icon_dsc, "Previous");
-        
-        lv_obj_add_event_cb(btn_waveform_1, event_handler, LV_EVENT_CLICKED, NULL);
-        
-    
-    
-    
-    lv_obj_t *list_level_fine = lv_list_create(scr_level_fine);
-    lv_obj_center(list_level_fine);
-    lv_obj_add_style(list_level_fine, &style_focus, LV_PART_ITEMS | LV_STATE_FOCUSED);
-    lv_obj_add_style(list_level_fine, &style_normal, LV_PART_ITEMS);
-        
-        
-        lv_obj_t *btn_level_fine_0 = lv_list_add_btn(list_level_fine, NULL, "Level Up");
-        
-        lv_obj_add_event_cb(btn_level_fine_0, event_handler, LV_EVENT_CLICKED, NULL);
-        
-        
-        lv_obj_t *btn_level_fine_1 = lv_list_add_btn(list_level_fine, NULL, "Level Down");
-        
-        lv_obj_add_event_cb(btn_level_fine_1, event_handler, LV_EVENT_CLICKED, NULL);
-        
-        
-        lv_obj_t *btn_level_fine_2 = lv_list_add_btn(list_level_fine, NULL, "Fine Tune Up");
-        
-        lv_obj_add_event_cb(btn_level_fine_2, event_handler, LV_EVENT_CLICKED, NULL);
-        
-        
-        lv_obj_t *btn_level_fine_3 = lv_list_add_btn(list_level_fine, NULL, "Fine Tune Down");
-        
-        lv_obj_add_event_cb(btn_level_fine_3, event_handler, LV_EVENT_CLICKED, NULL);
-        
-    
-    
-    
-    lv_obj_t *list_pw_ampmod = lv_list_create(scr_pw_ampmod);
-    lv_obj_center(list_pw_ampmod);
-    lv_obj_add_style(list_pw_ampmod, &style_focus, LV_PART_ITEMS | LV_STATE_FOCUSED);
-    lv_obj_add_style(list_pw_ampmod, &style_normal, LV_PART_ITEMS);
-        
-        
-        lv_obj_t *btn_pw_ampmod_0 = lv_list_add_btn(list_pw_ampmod, NULL, "Pulse Width Up");
-        
-        lv_obj_add_event_cb(btn_pw_ampmod_0, event_handler, LV_EVENT_CLICKED, NULL);
-        
-        
-        lv_obj_t *btn_pw_ampmod_1 = lv_list_add_btn(list_pw_ampmod, NULL, "Pulse Width Down");
-        
-        lv_obj_add_event_cb(btn_pw_ampmod_1, event_handler, LV_EVENT_CLICKED, NULL);
-        
-        
-        lv_obj_t *btn_pw_ampmod_2 = lv_list_add_btn(list_pw_ampmod, NULL, "Amp Mod Slot Next");
-        
-        lv_obj_add_event_cb(btn_pw_ampmod_2, event_handler, LV_EVENT_CLICKED, NULL);
-        
-        
-        lv_obj_t *btn_pw_ampmod_3 = lv_list_add_btn(list_pw_ampmod, NULL, "Amp Mod Slot Prev");
-        
-        lv_obj_add_event_cb(btn_pw_ampmod_3, event_handler, LV_EVENT_CLICKED, NULL);
-        
-    
-    
-    
-    lv_obj_t *list_favorites = lv_list_create(scr_favorites);
-    lv_obj_center(list_favorites);
-    lv_obj_add_style(list_favorites, &style_focus, LV_PART_ITEMS | LV_STATE_FOCUSED);
-    lv_obj_add_style(list_favorites, &style_normal, LV_PART_ITEMS);
-        
-        
-        lv_obj_t *btn_favorites_0 = lv_list_add_btn(list_favorites, NULL, "Select Next");
-        
-        lv_obj_add_event_cb(btn_favorites_0, event_handler, LV_EVENT_CLICKED, NULL);
-        
-        
-        lv_obj_t *btn_favorites_1 = lv_list_add_btn(list_favorites, NULL, "Select Prev");
-        
-        lv_obj_add_event_cb(btn_favorites_1, event_handler, LV_EVENT_CLICKED, NULL);
-        
-        
-        lv_obj_t *btn_favorites_2 = lv_list_add_btn(list_favorites, NULL, "Save");
-        
-        lv_obj_add_event_cb(btn_favorites_2, event_handler, LV_EVENT_CLICKED, NULL);
-        
-        
-        lv_obj_t *btn_favorites_3 = lv_list_add_btn(list_favorites, NULL, "Load");
-        
-        lv_obj_add_event_cb(btn_favorites_3, event_handler, LV_EVENT_CLICKED, NULL);
-        
-        
-        lv_obj_t *btn_favorites_4 = lv_list_add_btn(list_favorites, NULL, "Clear");
-        
-        lv_obj_add_event_cb(btn_favorites_4, event_handler, LV_EVENT_CLICKED, NULL);
-        
-    
-    
-    
-
-    // Show the main screen
-    lv_scr_load(scr_main);
+    esp_menu_engine_start(&s_menu_tree);
 }
\ No newline at end of file
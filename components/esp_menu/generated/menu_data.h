@@ -5,42 +5,62 @@
 #include <stdint.h>
 #include <stddef.h>
 
-
-void amp_mod_slot_next(void);
-
-void amp_mod_slot_prev(void);
+// Stable menu item IDs, assigned by the generator in menu.json order
+typedef enum {
+    MENU_ITEM_MAIN_PITCH = 0,
+    MENU_ITEM_MAIN_WAVEFORM = 1,
+    MENU_ITEM_MAIN_LEVEL_FINE = 2,
+    MENU_ITEM_MAIN_PW_AMPMOD = 3,
+    MENU_ITEM_MAIN_FAVORITES = 4,
+    MENU_ITEM_MAIN_PRESETS = 5,
+    MENU_ITEM_LEVEL_FINE_LEVEL = 6,
+    MENU_ITEM_LEVEL_FINE_FINE_TUNE = 7,
+    MENU_ITEM_PW_AMPMOD_PULSE_WIDTH = 8,
+    MENU_ITEM_PW_AMPMOD_AMP_MOD_SLOT = 9,
+    MENU_ITEM_FAVORITES_SELECT_NEXT = 10,
+    MENU_ITEM_FAVORITES_SELECT_PREV = 11,
+    MENU_ITEM_FAVORITES_SAVE = 12,
+    MENU_ITEM_FAVORITES_LOAD = 13,
+    MENU_ITEM_FAVORITES_CLEAR = 14,
+    MENU_ITEM_PRESETS_LOAD_PRESET = 15,
+    MENU_ITEM_PRESETS_SAVE_PRESET = 16,
+    MENU_ITEM_COUNT
+} menu_item_id_t;
+
+// Screen IDs; MENU_SCREEN_MAIN is the root
+typedef enum {
+    MENU_SCREEN_MAIN = 0,
+    MENU_SCREEN_LEVEL_FINE = 1,
+    MENU_SCREEN_PW_AMPMOD = 2,
+    MENU_SCREEN_FAVORITES = 3,
+    MENU_SCREEN_PRESETS = 4,
+    MENU_SCREEN_COUNT
+} menu_screen_id_t;
+
+// Parameter IDs, in the order of the "params" array of menu.json
+typedef enum {
+    MENU_PARAM_PITCH = 0,
+    MENU_PARAM_FINE_TUNE = 1,
+    MENU_PARAM_WAVEFORM = 2,
+    MENU_PARAM_LEVEL = 3,
+    MENU_PARAM_PULSE_WIDTH = 4,
+    MENU_PARAM_AMP_MOD_SLOT = 5,
+    MENU_PARAM_FREQ_MOD_SLOT = 6,
+    MENU_PARAM_SYNC_SLOT = 7,
+    MENU_PARAM_COUNT
+} menu_param_id_t;
+
+// Deepest menu level (root = 1); bounds the runtime navigation stack
+#define MENU_MAX_DEPTH 2
 
 void clear_favorite_action(void);
-
-void fine_tune_down(void);
-
-void fine_tune_up(void);
-
-void level_down(void);
-
-void level_up(void);
-
 void load_favorite_action(void);
-
-void pitch_down(void);
-
-void pitch_up(void);
-
-void pulse_width_down(void);
-
-void pulse_width_up(void);
-
+void preset_load_action(void);
+void preset_save_action(void);
 void save_favorite_action(void);
-
 void select_favorite_slot_next(void);
-
 void select_favorite_slot_prev(void);
 
-void waveform_next(void);
-
-void waveform_prev(void);
-
-
 void menu_init(void);
 
 #endif
\ No newline at end of file
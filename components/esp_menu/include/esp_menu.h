@@ -7,8 +7,31 @@
 #ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_H_
 #define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_H_
 
+#include <stddef.h>
+#include <stdint.h>
 #include "esp_err.h"  // NOLINT(build/include_subdir)
 
+/** @brief Runtime counters of the menu, see esp_menu_get_stats(). */
+typedef struct {
+	uint64_t sample_us;           ///< Time since boot or esp_menu_stats_reset()
+	uint32_t frames;              ///< Refreshes rendered and flushed
+	uint32_t area_px;             ///< Pixels redrawn, all refreshes
+	uint32_t last_frame_area_px;  ///< Pixels redrawn by the last refresh
+	uint64_t render_us;           ///< Rendering time, all refreshes
+	uint32_t last_render_us;      ///< Rendering time of the last refresh
+	uint64_t flush_us;            ///< Bus time, all refreshes
+	uint32_t last_flush_us;       ///< Bus time of the last refresh
+	uint32_t last_frame_us;       ///< Start of rendering to last transfer done, last refresh
+	uint32_t bytes_written;       ///< GDDRAM bytes written to the panel, commands excluded
+	uint32_t bytes_skipped;       ///< Redrawn bytes the panel already showed, not written
+	uint32_t spans;               ///< Panel transfers
+	size_t lvgl_heap_total;       ///< LVGL heap size
+	size_t lvgl_heap_used;        ///< LVGL heap in use now
+	size_t lvgl_heap_peak;        ///< Most LVGL heap ever in use
+	uint8_t lvgl_heap_frag_pct;   ///< LVGL heap fragmentation, 0-100
+	uint32_t lvgl_stack_free_min; ///< LVGL task stack never used, in bytes; 0 if unknown
+} esp_menu_stats_t;
+
 /**
  * @brief Initializes the ESP Menu system, including OLED display and rotary encoders.
  * @return esp_err_t ESP_OK on success, or an error code on failure.
@@ -22,4 +45,34 @@ esp_err_t esp_menu_init(void);
  */
 esp_err_t esp_menu_deinit(void);
 
+/**
+ * @brief Tell the menu that application state it displays has changed.
+ *
+ * Wakes the LVGL task, resuming it first if the menu is idle. Safe to call
+ * from any task, with or without the LVGL port lock; not from an ISR.
+ */
+void esp_menu_notify_update(void);
+
+/**
+ * @brief Sample the menu's frame, bus, heap and stack counters.
+ *
+ * Takes the LVGL port lock. Frame and bus counters come from the page-diff
+ * flush (CONFIG_ESPMENU_DISPLAY_DIFF_FLUSH) and stay 0 without it.
+ *
+ * @param out Destination.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG if @p out is NULL,
+ *         ESP_ERR_INVALID_STATE before esp_menu_init(), ESP_ERR_NOT_SUPPORTED
+ *         if CONFIG_ESPMENU_STATS is off.
+ */
+esp_err_t esp_menu_get_stats(esp_menu_stats_t *out);
+
+/**
+ * @brief Zero the frame and bus counters and the latency histograms.
+ *
+ * For A/B comparisons: reset, run the workload, then call
+ * esp_menu_get_stats(); sample_us is the length of the window. Heap and
+ * stack figures are not windowed.
+ */
+void esp_menu_stats_reset(void);
+
 #endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_H_
@@ -0,0 +1,75 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_direct.h
+ * @brief Direct-control encoders: knobs 2–4 bound straight to parameters.
+ *
+ * Encoder 1 drives LVGL navigation. The remaining encoders bypass the LVGL
+ * input device and group: every detent updates the bound parameter from the
+ * knob callback, and the menu row plus a short overlay are redrawn on the
+ * next LVGL frame.
+ */
+
+#ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_DIRECT_H_
+#define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_DIRECT_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "iot_button.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Number of direct-control encoders (encoders 2–4). */
+#define ESP_MENU_DIRECT_MAX 3
+
+/** @brief Binding that follows the n-th parameter row of the current screen. */
+#define ESP_MENU_DIRECT_FOLLOW 0xFFFEu
+
+/**
+ * @brief Create the knob for direct-control encoder @p index.
+ * @param index Direct encoder index, 0 for encoder 2.
+ * @param gpio_a Encoder A pin.
+ * @param gpio_b Encoder B pin.
+ * @param button Push button of the encoder, may be NULL. A click shows the
+ *        bound parameter in the overlay without changing it.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG for a bad index,
+ *         ESP_FAIL if the knob could not be created.
+ */
+esp_err_t esp_menu_direct_add(uint8_t index, int gpio_a, int gpio_b, button_handle_t button);
+
+/**
+ * @brief Bind a direct encoder to a parameter.
+ * @param index Direct encoder index, 0 for encoder 2.
+ * @param param Parameter ID, ESP_MENU_DIRECT_FOLLOW, or ESP_MENU_NO_PARAM to unbind.
+ */
+void esp_menu_direct_bind(uint8_t index, uint16_t param);
+
+/**
+ * @brief Parameter a direct encoder currently controls, with follow mode resolved.
+ * @param index Direct encoder index, 0 for encoder 2.
+ * @return uint16_t Parameter ID, or ESP_MENU_NO_PARAM if it controls nothing.
+ */
+uint16_t esp_menu_direct_get_param(uint8_t index);
+
+/**
+ * @brief Create the overlay and the per-frame refresh timer.
+ *
+ * Must be called with the LVGL port lock held, after the menu is built.
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if LVGL objects could not be created.
+ */
+esp_err_t esp_menu_direct_start(void);
+
+/**
+ * @brief Delete the knobs, the refresh timer and the overlay.
+ *
+ * Must be called with the LVGL port lock held.
+ */
+void esp_menu_direct_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_DIRECT_H_
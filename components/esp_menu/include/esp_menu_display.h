@@ -0,0 +1,145 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_display.h
+ * @brief Monochrome LVGL display that sends only the changed parts of each page.
+ *
+ * SSD1306-class controllers store the frame as pages of 8 pixel rows, one
+ * byte per column. The display keeps a shadow of the panel's GDDRAM,
+ * converts each flushed area into it, and sends only the column spans of
+ * each page whose bytes changed, each with one esp_lcd_panel_draw_bitmap().
+ * LVGL's row-major pixels are converted to the panel's column bytes a tile
+ * of 8x8 pixels at a time rather than pixel by pixel.
+ */
+
+#ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_DISPLAY_H_
+#define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_DISPLAY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Bus traffic counters. */
+typedef struct {
+	uint32_t frames;            ///< Refreshes flushed
+	uint32_t spans;             ///< esp_lcd_panel_draw_bitmap() calls
+	uint32_t bytes_sent;        ///< GDDRAM bytes sent
+	uint32_t bytes_skipped;     ///< Flushed bytes already on the panel, not sent
+	uint32_t last_frame_bytes;  ///< GDDRAM bytes sent for the last refresh
+	uint32_t last_frame_spans;  ///< Spans sent for the last refresh
+	uint32_t last_render_us;    ///< Rendering and conversion time of the last refresh
+	uint32_t last_bus_us;       ///< Bus time of the last refresh, first transfer to last completion
+	uint32_t last_frame_us;     ///< Start of rendering to the last transfer done, last refresh
+	uint32_t area_px;           ///< Pixels rendered and flushed, all refreshes
+	uint32_t last_frame_area_px;  ///< Pixels rendered for the last refresh
+	uint64_t render_us_total;   ///< Rendering time of all refreshes
+	uint64_t bus_us_total;      ///< Bus time of all refreshes
+} esp_menu_display_stats_t;
+
+/** @brief Display geometry and draw buffer strategy. */
+typedef struct {
+	esp_lcd_panel_io_handle_t io;  ///< Panel IO; its color-transfer-done event completes flushes
+	esp_lcd_panel_handle_t panel;  ///< Panel driven with esp_lcd_panel_draw_bitmap() in page format
+	uint16_t hres;                 ///< Horizontal resolution
+	uint16_t vres;                 ///< Vertical resolution, a multiple of 8
+	uint16_t buf_lines;            ///< Rows per draw buffer, rounded down to whole pages; 0 for a full frame
+	bool double_buffer;            ///< Render into one buffer while the other is flushed
+	uint32_t buf_caps;             ///< heap_caps flags of the draw buffers, e.g. MALLOC_CAP_SPIRAM
+	uint8_t queue_depth;           ///< Spans queued to the flush task; 0 flushes in the LVGL task
+	int task_priority;             ///< Flush task priority
+	uint32_t task_stack;           ///< Flush task stack size
+} esp_menu_display_config_t;
+
+/** @brief RAM held by the display. */
+typedef struct {
+	uint32_t draw_buf_bytes;  ///< Size of one draw buffer, palette included
+	uint8_t draw_bufs;        ///< Draw buffers allocated, 1 or 2
+	uint16_t buf_lines;       ///< Rows each draw buffer holds
+	uint32_t shadow_bytes;    ///< GDDRAM shadow, always internal DMA-capable RAM
+	uint32_t total_bytes;     ///< Draw buffers plus shadow
+} esp_menu_display_mem_t;
+
+/**
+ * @brief Create the LVGL display for a page-addressed monochrome panel.
+ *
+ * Draw buffers hold 1 bit per pixel. With fewer lines than the panel,
+ * LVGL renders each refresh in bands of whole pages.
+ *
+ * With a queue depth, the flush callback only converts an area into the
+ * shadow and queues its changed spans; a flush task sends them while LVGL
+ * renders the next area, so a multi-area refresh takes about the longer of
+ * render and bus time instead of their sum.
+ *
+ * Must be called with the LVGL port lock held. The display is freed by
+ * lv_display_delete().
+ *
+ * @param config Geometry and buffer strategy.
+ * @return lv_display_t* The display, or NULL on allocation failure or bad geometry.
+ */
+lv_display_t *esp_menu_display_create(const esp_menu_display_config_t *config);
+
+/**
+ * @brief Report the RAM held by the display.
+ * @param out Destination.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG if @p out is NULL,
+ *         ESP_ERR_INVALID_STATE if no display exists.
+ */
+esp_err_t esp_menu_display_get_mem(esp_menu_display_mem_t *out);
+
+/**
+ * @brief Read the bus traffic counters.
+ * @param out Destination.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG if @p out is NULL,
+ *         ESP_ERR_INVALID_STATE if no display exists.
+ */
+esp_err_t esp_menu_display_get_stats(esp_menu_display_stats_t *out);
+
+/**
+ * @brief Zero the bus traffic counters, e.g. before sampling a workload.
+ *
+ * Must be called with the LVGL port lock held. A refresh still on the bus
+ * may add its bus time after the reset.
+ */
+void esp_menu_display_reset_stats(void);
+
+/**
+ * @brief Take the lock that serialises panel IO with the display's transfers.
+ *
+ * The flush task drives the panel IO without the LVGL port lock, and esp_lcd
+ * panel IO is not thread-safe. Hold this lock around any other command sent
+ * to the panel, such as contrast or esp_lcd_panel_disp_on_off(). It may be
+ * taken with the LVGL port lock held, never the other way round. Does
+ * nothing before the first esp_menu_display_create().
+ */
+void esp_menu_display_io_lock(void);
+
+/**
+ * @brief Release the lock taken by esp_menu_display_io_lock().
+ */
+void esp_menu_display_io_unlock(void);
+
+/**
+ * @brief Convert 8 rows of LVGL I1 pixels into GDDRAM page bytes.
+ *
+ * The conversion used by the flush path, exposed for benchmarks and for
+ * applications that drive a panel themselves. Works on 8x8 tiles; one
+ * output byte per column, bit n being row n, set for a lit pixel.
+ *
+ * @param px First of the 8 rows, MSB-first, no palette.
+ * @param stride Bytes per row.
+ * @param width Columns to convert.
+ * @param out Destination of @p width bytes, e.g. a DMA transfer buffer.
+ */
+void esp_menu_display_pack_page(const uint8_t *px, uint32_t stride, uint16_t width, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_DISPLAY_H_
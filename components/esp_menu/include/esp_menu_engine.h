@@ -0,0 +1,168 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_engine.h
+ * @brief Descriptor types for the generated menu tree and the runtime engine that builds it.
+ *
+ * The generator emits a const esp_menu_tree_t (screens, items, labels, icons
+ * and callbacks) that lives in flash. The engine walks it to create LVGL
+ * screens, so menu size costs table entries rather than code.
+ */
+
+#ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_ENGINE_H_
+#define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_ENGINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_menu_param.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Marks an item without a child screen. */
+#define ESP_MENU_NO_SCREEN 0xFFFFu
+
+/** @brief Behaviour of a menu item when clicked. */
+typedef enum {
+	ESP_MENU_ITEM_ACTION = 0,  ///< Calls the item's action callback
+	ESP_MENU_ITEM_SUBMENU,     ///< Loads the item's child screen
+	ESP_MENU_ITEM_PARAM,       ///< Shows a parameter value; click toggles encoder editing
+} esp_menu_item_type_t;
+
+/** @brief Action callback attached to a menu item. */
+typedef void (*esp_menu_action_cb_t)(void);
+
+/** @brief One row of a menu screen. */
+typedef struct {
+	const char *label;                ///< Text shown in the list
+	const lv_image_dsc_t *icon;       ///< Optional icon, NULL for none
+	esp_menu_action_cb_t action;      ///< Callback for ESP_MENU_ITEM_ACTION
+	uint16_t child_screen;            ///< Screen index for ESP_MENU_ITEM_SUBMENU
+	uint16_t param;                   ///< Parameter ID for ESP_MENU_ITEM_PARAM
+	uint8_t type;                     ///< esp_menu_item_type_t
+} esp_menu_item_desc_t;
+
+/** @brief A screen is a contiguous range of items in the item table. */
+typedef struct {
+	const char *name;                 ///< Screen name from menu.json
+	uint16_t first_item;              ///< Index of the first item in the item table
+	uint16_t item_count;              ///< Number of items on this screen
+} esp_menu_screen_desc_t;
+
+/** @brief Saved state of a screen the user navigated away from. */
+typedef struct {
+	uint16_t screen;                  ///< Screen index
+	uint32_t focus_index;             ///< Index of the focused row
+	int32_t scroll_y;                 ///< Vertical scroll offset of the list
+} esp_menu_nav_frame_t;
+
+/** @brief Complete menu tree as emitted by the generator. */
+typedef struct {
+	const esp_menu_screen_desc_t *screens;  ///< Screen table, root first
+	const esp_menu_item_desc_t *items;      ///< Item table, indexed by menu_item_id_t
+	uint16_t screen_count;                  ///< Entries in screens
+	uint16_t item_count;                    ///< Entries in items
+	esp_menu_nav_frame_t *nav_stack;        ///< Navigation stack storage, max_depth entries
+	uint8_t max_depth;                      ///< Deepest menu level, root = 1
+	const esp_menu_param_table_t *params;   ///< Parameter table, NULL if none
+	const uint16_t *direct_params;          ///< Bindings of encoders 2–4 (see esp_menu_direct.h)
+	uint8_t direct_count;                   ///< Entries in direct_params
+	void (*screen_init)(lv_obj_t *screen);  ///< Optional hook run on every new screen
+} esp_menu_tree_t;
+
+/** @brief Screen residency and LVGL heap figures for sizing LV_MEM_SIZE. */
+typedef struct {
+	uint32_t resident_screens;  ///< Screens currently alive, root included
+	uint32_t screens_built;     ///< Screens constructed since start
+	uint32_t screens_evicted;   ///< Screens deleted by the LRU policy
+	size_t lvgl_heap_total;     ///< LVGL heap size (LV_MEM_SIZE)
+	size_t lvgl_heap_used;      ///< LVGL heap in use at the last sample
+	size_t lvgl_heap_peak;      ///< LVGL heap high-water mark
+} esp_menu_engine_mem_stats_t;
+
+/**
+ * @brief Build the root screen of @p tree (and, unless CONFIG_ESPMENU_LAZY_SCREENS
+ *        is set, every submenu screen) and show it.
+ *
+ * Must be called with the LVGL port lock held or from the LVGL task. Items
+ * are added to the default LVGL group of the screen being shown.
+ *
+ * @param tree Menu tree; must stay valid for the lifetime of the menu.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG for an empty tree,
+ *         ESP_ERR_NO_MEM if screen bookkeeping could not be allocated.
+ */
+esp_err_t esp_menu_engine_start(const esp_menu_tree_t *tree);
+
+/**
+ * @brief Jump to a screen of the running tree and move encoder focus to it.
+ *
+ * Clears the navigation stack; esp_menu_engine_back() from the new screen
+ * returns to the root.
+ *
+ * @param screen Index into the tree's screen table.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE before start,
+ *         ESP_ERR_INVALID_ARG for an unknown screen.
+ */
+esp_err_t esp_menu_engine_show(uint16_t screen);
+
+/**
+ * @brief Return to the previous screen, restoring its focus and scroll position.
+ *
+ * Screens on the navigation stack are kept alive, so going back never
+ * rebuilds them.
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE before start or
+ *         when already at the root.
+ */
+esp_err_t esp_menu_engine_back(void);
+
+/**
+ * @brief Parameter of the @p n-th parameter row on the screen currently shown.
+ *
+ * Used by direct-control encoders in follow mode. The engine publishes the
+ * first ESP_MENU_DIRECT_MAX rows whenever a screen is shown, so this is safe
+ * to call from any task without the LVGL port lock.
+ *
+ * @param n Zero-based index among the screen's parameter rows.
+ * @return uint16_t Parameter ID, or ESP_MENU_NO_PARAM if the screen has fewer
+ *         rows or @p n is not below ESP_MENU_DIRECT_MAX.
+ */
+uint16_t esp_menu_engine_screen_param(uint8_t n);
+
+/**
+ * @brief Redraw every row of the current screen that shows @p param.
+ *
+ * Must be called with the LVGL port lock held or from the LVGL task.
+ *
+ * @param param Parameter ID whose value changed outside the menu.
+ */
+void esp_menu_engine_refresh_param(uint16_t param);
+
+/**
+ * @brief Redraw every parameter row of the current screen, e.g. after
+ *        parameters were loaded from storage. Other screens catch up when shown.
+ *
+ * Must be called with the LVGL port lock held or from the LVGL task.
+ */
+void esp_menu_engine_refresh(void);
+
+/**
+ * @brief Report screen residency and LVGL heap usage, including the high-water
+ *        mark. Heap figures require LVGL's built-in allocator.
+ * @param out Destination for the figures.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG if @p out is NULL.
+ */
+esp_err_t esp_menu_engine_get_mem_stats(esp_menu_engine_mem_stats_t *out);
+
+/**
+ * @brief Release engine bookkeeping. LVGL objects are deleted with the display.
+ */
+void esp_menu_engine_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_ENGINE_H_
@@ -0,0 +1,56 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_idle.h
+ * @brief Suspends LVGL while the menu is idle.
+ *
+ * After CONFIG_ESPMENU_LVGL_IDLE_TIMEOUT_MS without input, running
+ * animations or redraws, the LVGL tick and timers are stopped with
+ * lvgl_port_stop(), so the LVGL task blocks until the next event instead of
+ * polling. Knobs, buttons, invalidated objects and esp_menu_notify_update()
+ * resume LVGL before their update is processed.
+ *
+ * With CONFIG_ESPMENU_POWER_SAVE, esp_pm locks that keep the CPU at full
+ * speed and prevent light sleep are held only while LVGL runs.
+ */
+
+#ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_IDLE_H_
+#define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_IDLE_H_
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start idle tracking on @p disp.
+ *
+ * Must be called with the LVGL port lock held. Does nothing unless
+ * CONFIG_ESPMENU_LVGL_IDLE is set.
+ *
+ * @param disp Menu display.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the idle timer
+ *         could not be created, or the error of esp_pm_lock_create().
+ */
+esp_err_t esp_menu_idle_start(lv_display_t *disp);
+
+/**
+ * @brief Resume LVGL if suspended and stop idle tracking.
+ *
+ * Must be called with the LVGL port lock held, before the display is deleted.
+ */
+void esp_menu_idle_stop(void);
+
+/**
+ * @brief Whether LVGL is currently suspended.
+ * @return bool true while idle.
+ */
+bool esp_menu_idle_active(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_IDLE_H_
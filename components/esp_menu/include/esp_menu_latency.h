@@ -0,0 +1,137 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_latency.h
+ * @brief Input-to-photon latency histograms.
+ *
+ * Knob and button callbacks stamp an input with esp_timer_get_time(). The
+ * stamp follows the input through the LVGL read, the item's event handler
+ * and action, and the next refresh, and is closed when that refresh's last
+ * transfer completes. Each stage keeps a histogram with power-of-two
+ * microsecond buckets:
+ *
+ * - input: stamp to the LVGL input read that consumes it
+ * - action: menu event handler, including the item's action callback
+ * - render: LVGL rendering and page conversion of a refresh
+ * - bus: first transfer to last completion of a refresh
+ * - total: stamp to the end of the refresh showing its result
+ *
+ * Inputs arriving while a stamp is in flight are folded into it, so totals
+ * are measured from the first of a burst. A stamp that no refresh picks up
+ * within ESP_MENU_LATENCY_STALE_MS is dropped.
+ */
+
+#ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_LATENCY_H_
+#define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_LATENCY_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Histogram buckets; bucket n counts [2^n, 2^(n+1)) us, the last one everything above. */
+#define ESP_MENU_LATENCY_BUCKETS 21
+
+/** @brief Age after which an input stamp no refresh has picked up is dropped. */
+#define ESP_MENU_LATENCY_STALE_MS 1000
+
+/** @brief Measured stages. */
+typedef enum {
+	ESP_MENU_LATENCY_INPUT,   ///< Input callback to LVGL read
+	ESP_MENU_LATENCY_ACTION,  ///< Event handler and action
+	ESP_MENU_LATENCY_RENDER,  ///< Rendering of a refresh
+	ESP_MENU_LATENCY_BUS,     ///< Bus transfer of a refresh
+	ESP_MENU_LATENCY_TOTAL,   ///< Input callback to transfer complete
+	ESP_MENU_LATENCY_STAGES,
+} esp_menu_latency_stage_t;
+
+/** @brief Samples of one stage. */
+typedef struct {
+	uint32_t count;
+	uint32_t min_us;
+	uint32_t max_us;
+	uint32_t last_us;
+	uint64_t sum_us;
+	uint32_t buckets[ESP_MENU_LATENCY_BUCKETS];
+} esp_menu_latency_hist_t;
+
+/**
+ * @brief Stamp an input event. Call from knob and button callbacks, not from an ISR.
+ */
+void esp_menu_latency_input(void);
+
+/**
+ * @brief The LVGL input read consumed the stamped input. LVGL task only.
+ */
+void esp_menu_latency_read(void);
+
+/**
+ * @brief Start timing an event handler. LVGL task only.
+ * @return int64_t Start time, or 0 if no input is in flight.
+ */
+int64_t esp_menu_latency_action_begin(void);
+
+/**
+ * @brief Finish timing an event handler.
+ * @param begin Value returned by esp_menu_latency_action_begin(); 0 records nothing.
+ */
+void esp_menu_latency_action_end(int64_t begin);
+
+/**
+ * @brief Take the input stamp for the refresh that is starting. LVGL task only.
+ * @return int64_t Input time, or 0 if no input waits for a refresh.
+ */
+int64_t esp_menu_latency_claim(void);
+
+/**
+ * @brief Record a completed refresh.
+ * @param input_us Stamp from esp_menu_latency_claim(), or 0.
+ * @param render_us Rendering time of the refresh.
+ * @param bus_us Bus time of the refresh.
+ */
+void esp_menu_latency_frame(int64_t input_us, uint32_t render_us, uint32_t bus_us);
+
+/**
+ * @brief Copy the histogram of one stage.
+ * @param stage Stage to read.
+ * @param out Destination.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG for a bad stage or NULL @p out,
+ *         ESP_ERR_NOT_SUPPORTED if CONFIG_ESPMENU_LATENCY_STATS is off.
+ */
+esp_err_t esp_menu_latency_get(esp_menu_latency_stage_t stage, esp_menu_latency_hist_t *out);
+
+/**
+ * @brief Approximate percentile of a histogram.
+ * @param hist Histogram.
+ * @param percent 0 to 100.
+ * @return uint32_t Upper bound of the bucket holding the percentile, capped at max_us; 0 if empty.
+ */
+uint32_t esp_menu_latency_percentile(const esp_menu_latency_hist_t *hist, uint8_t percent);
+
+/**
+ * @brief Clear all histograms.
+ */
+void esp_menu_latency_reset(void);
+
+/**
+ * @brief Name of a stage, e.g. "render".
+ */
+const char *esp_menu_latency_stage_name(esp_menu_latency_stage_t stage);
+
+/**
+ * @brief Register the "menu_latency" console command.
+ *
+ * Call after esp_console_init() or esp_console_new_repl_*(). The command
+ * prints count, min, mean, p50, p90, p99 and max per stage; "menu_latency
+ * reset" clears the histograms.
+ *
+ * @return esp_err_t ESP_OK on success, or the error of esp_console_cmd_register().
+ */
+esp_err_t esp_menu_latency_register_console(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_LATENCY_H_
@@ -0,0 +1,191 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_param.h
+ * @brief Typed menu parameters described by generated const descriptors.
+ *
+ * Parameters are declared in menu.json (type, range, step, wrap, NVS key and
+ * display format). The generator emits a descriptor table and value storage;
+ * this module is the single edit path used by the encoder, so no per-parameter
+ * up/down functions are needed.
+ */
+
+#ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_PARAM_H_
+#define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_PARAM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Marks an item that is not bound to a parameter. */
+#define ESP_MENU_NO_PARAM 0xFFFFu
+
+/** @brief Parameter wraps from max to min (and back) instead of clamping. */
+#define ESP_MENU_PARAM_FLAG_WRAP (1u << 0)
+
+/** @brief Storage type of a parameter; values are held as int32_t at runtime. */
+typedef enum {
+	ESP_MENU_PARAM_U8 = 0,
+	ESP_MENU_PARAM_I8,
+	ESP_MENU_PARAM_U16,
+	ESP_MENU_PARAM_I16,
+	ESP_MENU_PARAM_I32,
+	ESP_MENU_PARAM_BOOL,
+	ESP_MENU_PARAM_ENUM,   ///< Index into options
+} esp_menu_param_type_t;
+
+/** @brief Acceleration curve applied to encoder detents while editing. */
+typedef enum {
+	ESP_MENU_ACCEL_NONE = 0,    ///< Always one step per detent
+	ESP_MENU_ACCEL_LINEAR,      ///< Multiplier grows linearly with the detent rate
+	ESP_MENU_ACCEL_QUADRATIC,   ///< Fine at moderate speed, steep towards a flick
+} esp_menu_param_accel_t;
+
+/** @brief Detent timing of one encoder, from which the acceleration is derived. */
+typedef struct {
+	int64_t last_us;        ///< Time of the previous detent
+	uint32_t interval_us;   ///< Smoothed time between detents
+	int8_t dir;             ///< Direction of the previous detent
+} esp_menu_accel_state_t;
+
+/** @brief Called after a parameter value changed. */
+typedef void (*esp_menu_param_change_cb_t)(int32_t value);
+
+/** @brief Notified after any parameter changed, e.g. by the persistence layer. */
+typedef void (*esp_menu_param_observer_t)(uint16_t id, int32_t value);
+
+/** @brief Const description of one parameter. */
+typedef struct {
+	const char *label;                  ///< Text shown in the menu
+	const char *nvs_key;                ///< NVS key, NULL if not persisted
+	const char *format;                 ///< printf format taking one int, NULL for "%d"
+	const char *const *options;         ///< Option labels for ESP_MENU_PARAM_ENUM
+	esp_menu_param_change_cb_t on_change;  ///< Optional change callback
+	int32_t min;                        ///< Lowest value
+	int32_t max;                        ///< Highest value
+	int32_t step;                       ///< Change per encoder detent
+	int32_t def;                        ///< Default value
+	uint16_t accel_max;                 ///< Step multiplier at full speed, 0 derives it from the range
+	uint8_t type;                       ///< esp_menu_param_type_t
+	uint8_t flags;                      ///< ESP_MENU_PARAM_FLAG_*
+	uint8_t accel;                      ///< esp_menu_param_accel_t
+} esp_menu_param_desc_t;
+
+/** @brief Generated parameter table: descriptors plus RAM value storage. */
+typedef struct {
+	const esp_menu_param_desc_t *descs;  ///< Descriptors, indexed by menu_param_id_t
+	int32_t *values;                     ///< Current values, same indexing
+	uint16_t count;                      ///< Number of parameters
+} esp_menu_param_table_t;
+
+/**
+ * @brief Register the generated parameter table and load its defaults.
+ * @param table Parameter table; must stay valid for the lifetime of the menu.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG for a NULL table.
+ */
+esp_err_t esp_menu_param_register(const esp_menu_param_table_t *table);
+
+/**
+ * @brief Number of registered parameters.
+ * @return uint16_t Parameter count, 0 before registration.
+ */
+uint16_t esp_menu_param_count(void);
+
+/**
+ * @brief Descriptor of a parameter.
+ * @param id Parameter ID (menu_param_id_t).
+ * @return const esp_menu_param_desc_t* Descriptor, or NULL for an unknown ID.
+ */
+const esp_menu_param_desc_t *esp_menu_param_get_desc(uint16_t id);
+
+/**
+ * @brief Current value of a parameter.
+ * @param id Parameter ID (menu_param_id_t).
+ * @return int32_t Value, 0 for an unknown ID.
+ */
+int32_t esp_menu_param_get(uint16_t id);
+
+/**
+ * @brief Set a parameter, clamped to its range.
+ * @param id Parameter ID (menu_param_id_t).
+ * @param value New value.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG for an unknown ID.
+ */
+esp_err_t esp_menu_param_set(uint16_t id, int32_t value);
+
+/**
+ * @brief Move a parameter by a number of steps, honouring clamp or wrap.
+ *
+ * This is the encoder hot path: no allocation, no logging, and the change
+ * callback only runs when the value actually changed. Safe to call from the
+ * LVGL task and from the direct-control knob callbacks concurrently; the
+ * change callback runs in the caller's context.
+ *
+ * @param id Parameter ID (menu_param_id_t).
+ * @param steps Signed number of steps.
+ * @return bool true if the value changed.
+ */
+bool esp_menu_param_step(uint16_t id, int32_t steps);
+
+/**
+ * @brief Scale encoder detents by the parameter's acceleration curve.
+ *
+ * The detent rate is measured from the time between calls and smoothed per
+ * encoder in @p state. Below CONFIG_ESPMENU_ACCEL_SLOW_MS per detent every
+ * detent is one step; at CONFIG_ESPMENU_ACCEL_FAST_MS or faster it is
+ * accel_max steps. A direction change or a pause restarts at single steps.
+ * Returns @p detents unchanged when CONFIG_ESPMENU_ENCODER_ACCEL is off.
+ *
+ * @param id Parameter ID (menu_param_id_t).
+ * @param state Timing state of the encoder that produced the detents.
+ * @param detents Signed detents received in this event.
+ * @return int32_t Signed number of steps to pass to esp_menu_param_step().
+ */
+int32_t esp_menu_param_accel(uint16_t id, esp_menu_accel_state_t *state, int32_t detents);
+
+/**
+ * @brief Format a parameter's value for display.
+ * @param id Parameter ID (menu_param_id_t).
+ * @param buf Destination buffer.
+ * @param len Size of @p buf.
+ * @return int Characters written as by snprintf(), or -1 for an unknown ID.
+ */
+int esp_menu_param_format(uint16_t id, char *buf, size_t len);
+
+/**
+ * @brief Restore every parameter to its default value.
+ */
+void esp_menu_param_reset_defaults(void);
+
+/**
+ * @brief FNV-1a hash of a parameter's NVS key.
+ *
+ * Stored snapshots (the parameter record, presets, favorites) tag each value
+ * with this hash and match it back by key, so adding, removing or reordering
+ * parameters in menu.json keeps every value whose key survived. The
+ * generator rejects keys whose hashes collide.
+ *
+ * @param id Parameter ID (menu_param_id_t).
+ * @return uint32_t Hash, never 0; 0 for an unknown ID or a parameter without nvs_key.
+ */
+uint32_t esp_menu_param_key_hash(uint16_t id);
+
+/**
+ * @brief Install the observer called after every change, following on_change.
+ *
+ * There is a single observer slot; it runs in the context of whoever changed
+ * the value and must not block.
+ *
+ * @param observer Observer, or NULL to remove it.
+ */
+void esp_menu_param_set_observer(esp_menu_param_observer_t observer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_PARAM_H_
@@ -0,0 +1,128 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_preset.h
+ * @brief Indexed preset bank of parameter snapshots in NVS.
+ *
+ * Presets live in their own NVS namespace (optionally on their own
+ * partition). An index split into pages of ESP_MENU_PRESET_PAGE_SIZE
+ * entries holds each preset's name, size and CRC; a preset body is read
+ * only when it is loaded. Only one index page is cached, so RAM use and
+ * start-up time do not depend on the size of the bank. Writes are queued
+ * to the persistence worker of esp_menu_store.
+ *
+ * A body holds the value of every parameter with an nvs_key, tagged with
+ * esp_menu_param_key_hash(), so presets keep loading after parameters are
+ * added, removed or reordered in menu.json.
+ */
+
+#ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_PRESET_H_
+#define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_PRESET_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Longest preset name including the terminator. */
+#define ESP_MENU_PRESET_NAME_MAX 16
+
+/** @brief Index entries per NVS index page. */
+#define ESP_MENU_PRESET_PAGE_SIZE 16
+
+/** @brief Index entry of one preset. */
+typedef struct {
+	char name[ESP_MENU_PRESET_NAME_MAX];  ///< NUL-terminated name
+	uint16_t count;                       ///< Values in the body, 0 if the slot is empty
+	uint32_t crc;                         ///< CRC-32 of the body
+} esp_menu_preset_info_t;
+
+/** @brief What a click in the preset browser does. */
+typedef enum {
+	ESP_MENU_PRESET_BROWSE_LOAD = 0,  ///< Apply the selected preset
+	ESP_MENU_PRESET_BROWSE_SAVE,      ///< Store the current parameters in the selected slot
+} esp_menu_preset_browse_mode_t;
+
+/**
+ * @brief Open the preset namespace. Reads nothing from the bank.
+ *
+ * Call after esp_menu_store_init(), which runs the preset writes.
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE if already
+ *         open, or the error of nvs_open_from_partition().
+ */
+esp_err_t esp_menu_preset_init(void);
+
+/**
+ * @brief Close the preset namespace.
+ *
+ * Call after esp_menu_store_deinit(), which runs the queued preset writes.
+ */
+void esp_menu_preset_deinit(void);
+
+/**
+ * @brief Number of preset slots, CONFIG_ESPMENU_PRESET_COUNT.
+ * @return uint16_t Slot count.
+ */
+uint16_t esp_menu_preset_capacity(void);
+
+/**
+ * @brief Read the index entry of a slot; loads its index page if it is not cached.
+ * @param index Slot index.
+ * @param out Destination; count is 0 for an empty slot.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG for a bad slot or
+ *         NULL @p out, ESP_ERR_INVALID_STATE before init.
+ */
+esp_err_t esp_menu_preset_get_info(uint16_t index, esp_menu_preset_info_t *out);
+
+/**
+ * @brief Read a preset body and apply it to the parameters.
+ *
+ * Values are matched by NVS key. Persisted parameters the preset does not
+ * hold are reset to their default; parameters without an nvs_key are left
+ * alone.
+ *
+ * @param index Slot index.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND for an empty slot,
+ *         ESP_ERR_INVALID_CRC if the body does not match the index.
+ */
+esp_err_t esp_menu_preset_load(uint16_t index);
+
+/**
+ * @brief Snapshot the parameters that have an nvs_key into a slot; the write is queued.
+ * @param index Slot index.
+ * @param name Preset name, truncated to ESP_MENU_PRESET_NAME_MAX - 1
+ *        characters; NULL names it after the slot.
+ * @return esp_err_t ESP_OK once queued, ESP_ERR_NOT_SUPPORTED if no
+ *         parameter has an nvs_key, ESP_ERR_NO_MEM, or the error of
+ *         esp_menu_store_post().
+ */
+esp_err_t esp_menu_preset_save(uint16_t index, const char *name);
+
+/**
+ * @brief Empty a slot; the erase is queued.
+ * @param index Slot index.
+ * @return esp_err_t ESP_OK once queued, or the error of esp_menu_store_post().
+ */
+esp_err_t esp_menu_preset_delete(uint16_t index);
+
+/**
+ * @brief Show the preset browser in place of the menu.
+ *
+ * The browser is a virtualized list over every slot with a Back row first.
+ * Clicking a slot loads or saves it according to @p mode and returns to the
+ * menu screen that was shown before. Must be called with the LVGL port lock
+ * held or from the LVGL task, e.g. from a menu action.
+ *
+ * @param mode Load or save.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE before init or
+ *         if the browser is already open, ESP_ERR_NO_MEM.
+ */
+esp_err_t esp_menu_preset_browser_open(esp_menu_preset_browse_mode_t mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_PRESET_H_
@@ -0,0 +1,72 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_saver.h
+ * @brief Screen saver: dims, then switches off the panel without input.
+ *
+ * Input callbacks report activity with esp_menu_saver_activity(). After
+ * CONFIG_ESPMENU_SAVER_DIM_S seconds without it the contrast drops to
+ * CONFIG_ESPMENU_SAVER_DIM_CONTRAST; after CONFIG_ESPMENU_SAVER_OFF_S the
+ * panel is turned off and LVGL invalidation is disabled, so nothing is
+ * rendered or flushed. The next input restores the panel and redraws the
+ * whole screen once.
+ */
+
+#ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_SAVER_H_
+#define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_SAVER_H_
+
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Panel state set by the screen saver. */
+typedef enum {
+	ESP_MENU_SAVER_ON,      ///< Full contrast
+	ESP_MENU_SAVER_DIMMED,  ///< Dimmed contrast
+	ESP_MENU_SAVER_OFF,     ///< Panel off, rendering suspended
+} esp_menu_saver_state_t;
+
+/**
+ * @brief Start the inactivity timer.
+ *
+ * Does nothing unless CONFIG_ESPMENU_SCREEN_SAVER is set.
+ *
+ * @param disp Menu display.
+ * @param io Panel IO, used for the contrast command.
+ * @param panel Panel, switched with esp_lcd_panel_disp_on_off().
+ * @return esp_err_t ESP_OK on success, or the error of esp_timer_create().
+ */
+esp_err_t esp_menu_saver_start(lv_display_t *disp, esp_lcd_panel_io_handle_t io,
+							   esp_lcd_panel_handle_t panel);
+
+/**
+ * @brief Turn the panel back on if needed and stop the timer.
+ *
+ * Must be called with the LVGL port lock held. Waits for a timer callback
+ * already in progress, which never blocks on that lock.
+ */
+void esp_menu_saver_stop(void);
+
+/**
+ * @brief Report user input; wakes the panel if it is dimmed or off.
+ *
+ * Cheap while the panel is on. Never takes the LVGL port lock: the wake is
+ * handed to the saver's timer. Must not be called from an ISR.
+ */
+void esp_menu_saver_activity(void);
+
+/**
+ * @brief Current panel state.
+ * @return esp_menu_saver_state_t ESP_MENU_SAVER_ON when the saver is disabled.
+ */
+esp_menu_saver_state_t esp_menu_saver_get_state(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_SAVER_H_
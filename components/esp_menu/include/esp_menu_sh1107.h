@@ -0,0 +1,58 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_sh1107.h
+ * @brief esp_lcd panel driver for the SH1107 OLED controller.
+ *
+ * The SH1107 has 128 columns (SEG) by 128 rows (COM) of display RAM in 16
+ * pages of 8 rows. The driver uses page addressing: every page of a drawn
+ * window is addressed with its page and start column, then only the
+ * window's columns are sent. Bitmaps use the same page format as the
+ * SSD1306 driver, one byte per column and page, bit n being row n.
+ *
+ * Panels must be wired with their width along SEG. Modules wired 64 SEG by
+ * 128 COM are used as 64x128.
+ */
+
+#ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_SH1107_H_
+#define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_SH1107_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_vendor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief SH1107 geometry, passed as esp_lcd_panel_dev_config_t::vendor_config. */
+typedef struct {
+	uint16_t width;   ///< Columns in use, at most 128
+	uint16_t height;  ///< Rows in use, a multiple of 8 up to 128
+} esp_menu_sh1107_config_t;
+
+/**
+ * @brief Create an SH1107 panel.
+ *
+ * esp_lcd_panel_set_gap() offsets columns by x_gap and pages by y_gap / 8.
+ * Each page of a drawn window is a separate color transfer, so the IO's
+ * transfer-done callback fires once per page.
+ *
+ * @param io Panel IO with 8-bit commands and parameters. Over SPI,
+ *        parameters must be sent with DC low (dc_low_on_param).
+ * @param panel_dev_config Reset GPIO and bits_per_pixel, which must be 1;
+ *        vendor_config may point to an esp_menu_sh1107_config_t, otherwise
+ *        128x128 is assumed.
+ * @param ret_panel Created panel.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG for a bad
+ *         configuration, ESP_ERR_NO_MEM, or the error of gpio_config().
+ */
+esp_err_t esp_menu_new_panel_sh1107(const esp_lcd_panel_io_handle_t io,
+									const esp_lcd_panel_dev_config_t *panel_dev_config,
+									esp_lcd_panel_handle_t *ret_panel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_SH1107_H_
@@ -0,0 +1,197 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_store.h
+ * @brief Write-behind persistence of menu parameters in NVS.
+ *
+ * Every change marks the parameter dirty. With CONFIG_ESPMENU_AUTO_SAVE a
+ * debounce timer restarts on each change; once the values have been quiet
+ * for CONFIG_ESPMENU_AUTO_SAVE_DELAY_MS a low-priority worker writes the
+ * dirty keys whose value differs from what is already stored, followed by
+ * a single nvs_commit().
+ *
+ * With CONFIG_ESPMENU_STORE_BLOB all parameters are instead kept in one
+ * versioned, CRC-protected record that is rewritten as a whole when any of
+ * its values changed.
+ *
+ * CONFIG_ESPMENU_FAV_SLOTS favorite slots, each a snapshot of every
+ * parameter with an nvs_key, are read into RAM at init. Slot values are
+ * matched to parameters by key, as in the parameter record. Saving, loading
+ * and clearing a slot only touch that cache; slot writes are queued to the
+ * same worker.
+ *
+ * Flash writes stall code running from flash on both cores. Applications
+ * with real-time work register a window callback or a real-time task; the
+ * worker then writes only while the window is open, or once a batch has
+ * waited CONFIG_ESPMENU_STORE_MAX_DEFER_MS.
+ */
+
+#ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_STORE_H_
+#define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_STORE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Flash write counters. */
+typedef struct {
+	uint32_t flushes;         ///< Write-behind passes that found dirty parameters
+	uint32_t commits;         ///< nvs_commit() calls that wrote something
+	uint32_t keys_written;    ///< NVS entries written; one per record write in blob mode
+	uint32_t writes_skipped;  ///< Dirty parameters whose stored value was already current
+	uint32_t errors;          ///< Failed NVS writes or commits
+	uint32_t deferred;        ///< Write batches that waited for a window
+	uint32_t forced;          ///< Write batches run without a window after the maximum wait
+	uint32_t max_wait_ms;     ///< Longest wait for a window
+} esp_menu_store_stats_t;
+
+/**
+ * @brief Ask whether flash may be written now.
+ *
+ * Polled by the persistence worker before each write batch. Return true only
+ * when the real-time path can tolerate the flash cache being disabled for
+ * the length of an NVS write and commit (typically a few ms, longer if a
+ * sector must be erased), e.g. right after an audio buffer was refilled.
+ *
+ * @param ctx Context passed to esp_menu_store_set_window_cb().
+ * @return bool true if the window is open.
+ */
+typedef bool (*esp_menu_store_window_cb_t)(void *ctx);
+
+/**
+ * @brief Flash work run by the persistence worker.
+ *
+ * Runs with the store's NVS lock held, serialised with parameter and
+ * favorite writes. The job owns @p arg and must release it.
+ *
+ * @return esp_err_t ESP_OK on success; failures are counted in the stats.
+ */
+typedef esp_err_t (*esp_menu_store_job_t)(void *arg);
+
+/**
+ * @brief Load persisted parameters and start the write-behind worker.
+ *
+ * Call after the menu (and with it the parameter table) is initialised and
+ * nvs_flash_init() has succeeded.
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE if already
+ *         running or no parameters are registered, ESP_ERR_NO_MEM, or the
+ *         error of nvs_open().
+ */
+esp_err_t esp_menu_store_init(void);
+
+/**
+ * @brief Write pending changes, stop the worker and close NVS.
+ */
+void esp_menu_store_deinit(void);
+
+/**
+ * @brief Reload every persisted parameter from NVS.
+ *
+ * Missing keys, and keys stored with another type, keep their current value.
+ * A record that fails its CRC or version check resets every parameter to its
+ * default and is rewritten.
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE before init.
+ */
+esp_err_t esp_menu_store_load(void);
+
+/**
+ * @brief Ask the worker to write pending changes now, without waiting.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE before init.
+ */
+esp_err_t esp_menu_store_flush(void);
+
+/**
+ * @brief Write pending changes in the calling task and wait for the commit.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE before init, or
+ *         the first NVS error; failed keys stay dirty.
+ */
+esp_err_t esp_menu_store_sync(void);
+
+/**
+ * @brief Read the flash write counters.
+ * @param out Destination.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG if @p out is NULL.
+ */
+esp_err_t esp_menu_store_get_stats(esp_menu_store_stats_t *out);
+
+/**
+ * @brief Restrict flash writes to windows granted by the application.
+ * @param cb Window callback, NULL to remove it.
+ * @param ctx Passed to @p cb.
+ */
+void esp_menu_store_set_window_cb(esp_menu_store_window_cb_t cb, void *ctx);
+
+/**
+ * @brief Restrict flash writes to times when a real-time task is blocked.
+ *
+ * Only keeps writes from starting while the task is running or ready. It
+ * gives no deadline guarantee: a task blocked on I/O, such as an audio task
+ * waiting in i2s_channel_write(), counts as blocked nearly all the time and
+ * may need the CPU again halfway through a commit. Use a window callback
+ * when the task has deadlines; this gate suits tasks that block for long,
+ * known idle periods.
+ *
+ * @param task Task handle, NULL to remove it.
+ */
+void esp_menu_store_set_rt_task(TaskHandle_t task);
+
+/**
+ * @brief Queue flash work to run in the persistence worker.
+ *
+ * For modules with their own NVS data that must stay off the UI task.
+ *
+ * @param job Job to run.
+ * @param arg Argument handed to @p job; ownership passes to the job only on ESP_OK.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG if @p job is NULL,
+ *         ESP_ERR_INVALID_STATE before init, ESP_ERR_TIMEOUT if the queue is full.
+ */
+esp_err_t esp_menu_store_post(esp_menu_store_job_t job, void *arg);
+
+/**
+ * @brief Snapshot the parameters into a favorite slot; the write happens in the worker.
+ * @param slot Slot index, below CONFIG_ESPMENU_FAV_SLOTS.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE before init,
+ *         ESP_ERR_INVALID_ARG for a bad slot.
+ */
+esp_err_t esp_menu_store_fav_save(uint8_t slot);
+
+/**
+ * @brief Apply a favorite slot from the RAM cache.
+ *
+ * Parameters that change are written behind like any other edit. Parameters
+ * without an nvs_key are left alone; persisted parameters added since the
+ * slot was saved get their default.
+ *
+ * @param slot Slot index, below CONFIG_ESPMENU_FAV_SLOTS.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if the slot is empty,
+ *         ESP_ERR_INVALID_STATE before init, ESP_ERR_INVALID_ARG for a bad slot.
+ */
+esp_err_t esp_menu_store_fav_load(uint8_t slot);
+
+/**
+ * @brief Empty a favorite slot; the erase happens in the worker.
+ * @param slot Slot index, below CONFIG_ESPMENU_FAV_SLOTS.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE before init,
+ *         ESP_ERR_INVALID_ARG for a bad slot.
+ */
+esp_err_t esp_menu_store_fav_clear(uint8_t slot);
+
+/**
+ * @brief Whether a favorite slot holds a snapshot.
+ * @param slot Slot index.
+ * @return bool True if the slot is in use.
+ */
+bool esp_menu_store_fav_used(uint8_t slot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_STORE_H_
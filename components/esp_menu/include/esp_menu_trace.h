@@ -0,0 +1,113 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_trace.h
+ * @brief Timeline trace of menu activity, dumped as Chrome trace-event JSON.
+ *
+ * Input callbacks, the LVGL read, menu dispatch and item actions, NVS
+ * writes, refreshes and bus transfers record compact begin/end/instant
+ * events into one ring per core. Writers only bump an atomic index, so
+ * tracing never blocks and never takes a lock; the oldest events are
+ * overwritten when a ring is full.
+ *
+ * "menu_trace" prints the rings as Chrome trace-event JSON, one event per
+ * line, with one row per task. scripts/menu_trace_to_chrome.py extracts it
+ * from a serial log into a file for chrome://tracing or ui.perfetto.dev.
+ *
+ * The macros compile to nothing unless CONFIG_ESPMENU_TRACE is set.
+ */
+
+#ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_TRACE_H_
+#define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Traced activities; see esp_menu_trace_name() for the names in the dump. */
+typedef enum {
+	ESP_MENU_TRACE_INPUT,       ///< Knob detent or press; instant, arg: 0 navigation, 1 up direct knobs
+	ESP_MENU_TRACE_READ,        ///< LVGL read consumed input; instant, arg: detents
+	ESP_MENU_TRACE_DISPATCH,    ///< Menu event handler; arg: item, -1 for Back
+	ESP_MENU_TRACE_ACTION,      ///< Item action callback; arg: item
+	ESP_MENU_TRACE_NVS_WAIT,    ///< Store waiting for a write window and the lock; arg: 1 if forced
+	ESP_MENU_TRACE_NVS_COMMIT,  ///< nvs_commit(); arg: keys or record entries written
+	ESP_MENU_TRACE_RENDER,      ///< Refresh, start of rendering to last flush; arg: pixels
+	ESP_MENU_TRACE_FLUSH,       ///< One flush callback; arg: pixels
+	ESP_MENU_TRACE_BUS,         ///< First transfer of a refresh to the bus draining
+	ESP_MENU_TRACE_IDLE,        ///< LVGL suspended (arg 1) or resumed (arg 0); instant
+	ESP_MENU_TRACE_IDS,
+} esp_menu_trace_id_t;
+
+#ifdef CONFIG_ESPMENU_TRACE
+#define ESP_MENU_TRACE_BEGIN(id, arg) esp_menu_trace_emit((id), 'B', (int32_t)(arg))
+#define ESP_MENU_TRACE_END(id, arg) esp_menu_trace_emit((id), 'E', (int32_t)(arg))
+#define ESP_MENU_TRACE_INSTANT(id, arg) esp_menu_trace_emit((id), 'i', (int32_t)(arg))
+#else
+#define ESP_MENU_TRACE_BEGIN(id, arg) ((void)0)
+#define ESP_MENU_TRACE_END(id, arg) ((void)0)
+#define ESP_MENU_TRACE_INSTANT(id, arg) ((void)0)
+#endif
+
+/**
+ * @brief Record an event on the calling core's ring. Use the macros instead.
+ *
+ * Lock-free and safe from any task; not from an ISR.
+ *
+ * @param id Activity.
+ * @param phase 'B' begin, 'E' end or 'i' instant, as in the Chrome format.
+ * @param arg Value shown with the event.
+ */
+void esp_menu_trace_emit(esp_menu_trace_id_t id, char phase, int32_t arg);
+
+/**
+ * @brief Start or stop recording, e.g. to freeze the rings right after a stall.
+ *
+ * Recording is on after boot.
+ */
+void esp_menu_trace_enable(bool enable);
+
+/**
+ * @brief Drop every recorded event.
+ */
+void esp_menu_trace_clear(void);
+
+/**
+ * @brief Write the rings as Chrome trace-event JSON.
+ *
+ * Recording pauses while writing. Timestamps are microseconds since boot;
+ * events older than about 71 minutes are placed wrongly.
+ *
+ * @param out Stream, e.g. stdout.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG if @p out is NULL,
+ *         ESP_ERR_NOT_SUPPORTED if CONFIG_ESPMENU_TRACE is off.
+ */
+esp_err_t esp_menu_trace_dump(FILE *out);
+
+/**
+ * @brief Name of an activity in the dump, e.g. "nvs_commit".
+ */
+const char *esp_menu_trace_name(esp_menu_trace_id_t id);
+
+/**
+ * @brief Register the "menu_trace" console command.
+ *
+ * Call after esp_console_init() or esp_console_new_repl_*(). "menu_trace"
+ * dumps the trace; "clear", "stop" and "start" do the same as the
+ * functions above.
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_SUPPORTED if
+ *         CONFIG_ESPMENU_TRACE is off, or the error of esp_console_cmd_register().
+ */
+esp_err_t esp_menu_trace_register_console(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_TRACE_H_
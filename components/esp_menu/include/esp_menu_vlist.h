@@ -0,0 +1,110 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_vlist.h
+ * @brief Virtualized list widget for very long menus.
+ *
+ * Only the visible rows plus a small margin exist as LVGL objects. The
+ * encoder moves a selection over a logical item range and the rows are
+ * refilled from a callback, so memory is O(visible rows) rather than
+ * O(items).
+ */
+
+#ifndef COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_VLIST_H_
+#define COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_VLIST_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Content of one row, filled in by esp_menu_vlist_fill_cb_t. */
+typedef struct {
+	const char *text;   ///< Row text; may point into buf or to static storage
+	const void *icon;   ///< Optional image source (descriptor or LV_SYMBOL_*), NULL for none
+	char *buf;          ///< Scratch buffer for formatted text
+	size_t buf_size;    ///< Size of buf in bytes
+} esp_menu_vlist_row_t;
+
+/**
+ * @brief Fill @p row with the content of logical item @p index.
+ *
+ * Set row->text to a string that stays valid until the next fill of the same
+ * row; static strings are shown without copying.
+ */
+typedef void (*esp_menu_vlist_fill_cb_t)(uint32_t index, esp_menu_vlist_row_t *row, void *user_ctx);
+
+/** @brief Called when the encoder button is clicked on logical item @p index. */
+typedef void (*esp_menu_vlist_click_cb_t)(uint32_t index, void *user_ctx);
+
+/**
+ * @brief Called for every encoder key before the list moves its selection.
+ * @return bool true if the key was consumed and the selection must not move.
+ */
+typedef bool (*esp_menu_vlist_key_cb_t)(uint32_t index, uint32_t key, void *user_ctx);
+
+/** @brief Virtualized list configuration. */
+typedef struct {
+	uint32_t item_count;                 ///< Number of logical items
+	uint8_t visible_rows;                ///< Rows on screen; 0 derives it from the parent height
+	esp_menu_vlist_fill_cb_t fill_cb;    ///< Row content provider (required)
+	esp_menu_vlist_click_cb_t click_cb;  ///< Click handler, may be NULL
+	esp_menu_vlist_key_cb_t key_cb;      ///< Key hook, may be NULL
+	void *user_ctx;                      ///< Passed to all callbacks
+} esp_menu_vlist_config_t;
+
+/**
+ * @brief Create a virtualized list filling @p parent.
+ *
+ * The returned object is the only focusable part of the widget; add it to
+ * the encoder group and put the group in edit mode so rotation reaches it as
+ * LV_KEY_LEFT/LV_KEY_RIGHT.
+ *
+ * @param parent Parent object, usually a screen.
+ * @param cfg Configuration; copied.
+ * @return lv_obj_t* The list object, or NULL on allocation failure.
+ */
+lv_obj_t *esp_menu_vlist_create(lv_obj_t *parent, const esp_menu_vlist_config_t *cfg);
+
+/**
+ * @brief Change the number of logical items and refill the rows.
+ * @param vlist List created by esp_menu_vlist_create().
+ * @param item_count New item count.
+ */
+void esp_menu_vlist_set_count(lv_obj_t *vlist, uint32_t item_count);
+
+/**
+ * @brief Refill all rows, e.g. after the underlying data changed.
+ * @param vlist List created by esp_menu_vlist_create().
+ */
+void esp_menu_vlist_refresh(lv_obj_t *vlist);
+
+/**
+ * @brief Refill the row showing logical item @p index, if it is on screen.
+ * @param vlist List created by esp_menu_vlist_create().
+ * @param index Item index.
+ */
+void esp_menu_vlist_refresh_item(lv_obj_t *vlist, uint32_t index);
+
+/**
+ * @brief Select a logical item and scroll it into view.
+ * @param vlist List created by esp_menu_vlist_create().
+ * @param index Item index; clamped to the item range.
+ */
+void esp_menu_vlist_set_selected(lv_obj_t *vlist, uint32_t index);
+
+/**
+ * @brief Get the selected logical item.
+ * @param vlist List created by esp_menu_vlist_create().
+ * @return uint32_t Selected index, 0 for an empty list.
+ */
+uint32_t esp_menu_vlist_get_selected(lv_obj_t *vlist);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMPONENTS_ESP_MENU_INCLUDE_ESP_MENU_VLIST_H_
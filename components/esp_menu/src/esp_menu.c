@@ -3,13 +3,25 @@
 #include "button_gpio.h"
 #include "button_types.h"
 #include "driver/i2c_master.h"
+#include "driver/spi_master.h"
 #include "esp_err.h"
+#include "esp_heap_caps.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_ssd1306.h"
 #include "esp_lcd_panel_vendor.h"
 #include "esp_log.h"
 #include "esp_lvgl_port.h"
-#include "esp_lvgl_port_knob.h"
+#include "esp_menu_direct.h"
+#include "esp_menu_display.h"
+#include "esp_menu_engine.h"
+#include "esp_menu_idle.h"
+#include "esp_menu_latency.h"
+#include "esp_menu_preset.h"
+#include "esp_menu_saver.h"
+#include "esp_menu_sh1107.h"
+#include "esp_menu_store.h"
+#include "esp_menu_trace.h"
 #include "esp_timer.h"
 #include "iot_button.h"
 #include "iot_knob.h"
@@ -17,6 +29,9 @@
 #include "menu_data.h" // Generated menu system
 #include "nvs.h"
 #include "nvs_flash.h"
+#ifdef CONFIG_ESPMENU_POWER_SAVE
+#include "esp_sleep.h"
+#endif
 #include "sdkconfig.h"
 #include <stdint.h>
 #include <string.h>
@@ -27,10 +42,12 @@
 /** @brief Logging tag for ESP Menu component. */
 #define TAG "Esp_menu"
 
-// Forward declarations for menu support
-
-// Note: Encoder callbacks removed - using esp_lvgl_port_knob for proper LVGL
-// integration
+/** @brief Knob and button GPIO power save: interrupt wake instead of periodic polling. */
+#ifdef CONFIG_ESPMENU_POWER_SAVE
+#define INPUT_POWER_SAVE true
+#else
+#define INPUT_POWER_SAVE false
+#endif
 
 /** @brief Macro to check ESP error codes and return on failure with logging. */
 #define BSP_ERROR_CHECK_RETURN_ERR(x)                                          \
@@ -46,10 +63,137 @@
 static esp_lcd_panel_handle_t lcd_handle = NULL;
 static esp_lcd_panel_io_handle_t s_io_handle = NULL;
 static i2c_master_bus_handle_t s_i2c_bus = NULL;
+/** @brief SPI host of the display bus, -1 while no SPI bus is initialised. */
+static int s_spi_host = -1;
 static bool s_initialized = false;
 
+/** @brief Encoder 1: knob and push button behind the LVGL encoder input device. */
+static knob_handle_t s_nav_knob = NULL;
+static button_handle_t s_nav_button = NULL;
+static lv_indev_t *s_nav_indev = NULL;
+/** @brief Detents counted by the knob callbacks since LVGL last read them. */
+static int32_t s_nav_diff = 0;
+/** @brief Button level, and a press latched until LVGL has read it. */
+static bool s_nav_down = false;
+static bool s_nav_pressed = false;
+
+/**
+ * @brief Encoder button pressed; resume LVGL before the press is read.
+ */
+static void encoder_btn_wake_cb(void *arg, void *data) {
+	(void)arg;
+	(void)data;
+	esp_menu_saver_activity();
+	esp_menu_notify_update();
+}
+
+/**
+ * @brief Count a detent of encoder 1; @p data is +1 or -1. Runs in the knob's timer context.
+ */
+static void nav_knob_cb(void *arg, void *data) {
+	(void)arg;
+	esp_menu_latency_input();
+	ESP_MENU_TRACE_INSTANT(ESP_MENU_TRACE_INPUT, 0);
+	__atomic_add_fetch(&s_nav_diff, (int32_t)(intptr_t)data, __ATOMIC_RELEASE);
+	esp_menu_saver_activity();
+	esp_menu_notify_update();
+}
+
+static void nav_button_down_cb(void *arg, void *data) {
+	(void)arg;
+	(void)data;
+	esp_menu_latency_input();
+	ESP_MENU_TRACE_INSTANT(ESP_MENU_TRACE_INPUT, 0);
+	__atomic_store_n(&s_nav_down, true, __ATOMIC_RELEASE);
+	__atomic_store_n(&s_nav_pressed, true, __ATOMIC_RELEASE);
+	esp_menu_notify_update();
+}
+
+static void nav_button_up_cb(void *arg, void *data) {
+	(void)arg;
+	(void)data;
+	__atomic_store_n(&s_nav_down, false, __ATOMIC_RELEASE);
+	esp_menu_notify_update();
+}
+
+/**
+ * @brief LVGL read callback of encoder 1.
+ *
+ * Detents and presses are accumulated by callbacks, so those that arrive
+ * while LVGL is suspended or between reads are delivered on the next read.
+ */
+static void nav_read_cb(lv_indev_t *indev, lv_indev_data_t *data) {
+	(void)indev;
+	data->enc_diff = (int16_t)__atomic_exchange_n(&s_nav_diff, 0, __ATOMIC_ACQUIRE);
+	bool pressed = __atomic_exchange_n(&s_nav_pressed, false, __ATOMIC_ACQUIRE) ||
+				   __atomic_load_n(&s_nav_down, __ATOMIC_ACQUIRE);
+	data->state = pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+	if (data->enc_diff || pressed) {
+		esp_menu_latency_read();
+		ESP_MENU_TRACE_INSTANT(ESP_MENU_TRACE_READ, data->enc_diff);
+	}
+}
+
+/**
+ * @brief Create encoder 1's knob and its LVGL encoder input device with a new group.
+ *
+ * The knob is owned here rather than by esp_lvgl_port so its callbacks can
+ * wake the menu and it can run in power-save mode.
+ */
+static esp_err_t nav_encoder_create(lv_display_t *disp, int gpio_a, int gpio_b,
+									button_handle_t button) {
+	knob_config_t knob_cfg = {
+		.default_direction = 0,
+		.gpio_encoder_a = gpio_a,
+		.gpio_encoder_b = gpio_b,
+		.enable_power_save = INPUT_POWER_SAVE,
+	};
+	s_nav_knob = iot_knob_create(&knob_cfg);
+	if (!s_nav_knob) {
+		return ESP_FAIL;
+	}
+	BSP_ERROR_CHECK_RETURN_ERR(iot_knob_register_cb(s_nav_knob, KNOB_RIGHT, nav_knob_cb, (void *)1));
+	BSP_ERROR_CHECK_RETURN_ERR(iot_knob_register_cb(s_nav_knob, KNOB_LEFT, nav_knob_cb, (void *)-1));
+	BSP_ERROR_CHECK_RETURN_ERR(iot_button_register_cb(button, BUTTON_PRESS_DOWN, NULL,
+													  nav_button_down_cb, NULL));
+	BSP_ERROR_CHECK_RETURN_ERR(iot_button_register_cb(button, BUTTON_PRESS_UP, NULL,
+													  nav_button_up_cb, NULL));
+	s_nav_button = button;
+
+	lvgl_port_lock(0);
+	s_nav_indev = lv_indev_create();
+	if (s_nav_indev) {
+		lv_indev_set_type(s_nav_indev, LV_INDEV_TYPE_ENCODER);
+		lv_indev_set_read_cb(s_nav_indev, nav_read_cb);
+		lv_indev_set_display(s_nav_indev, disp);
+		lv_indev_set_group(s_nav_indev, lv_group_create());
+	}
+	lvgl_port_unlock();
+	return s_nav_indev ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+/**
+ * @brief Delete encoder 1's input device and knob. Must be called with the LVGL port lock held.
+ */
+static void nav_encoder_delete(void) {
+	if (s_nav_indev) {
+		lv_group_delete(lv_indev_get_group(s_nav_indev));
+		lv_indev_delete(s_nav_indev);
+		s_nav_indev = NULL;
+	}
+	if (s_nav_knob) {
+		iot_knob_delete(s_nav_knob);
+		s_nav_knob = NULL;
+	}
+	if (s_nav_button) {
+		iot_button_unregister_cb(s_nav_button, BUTTON_PRESS_DOWN, NULL);
+		iot_button_unregister_cb(s_nav_button, BUTTON_PRESS_UP, NULL);
+		s_nav_button = NULL;
+	}
+}
+
 /**
- * @brief Initializes the ESP Menu system, including I2C, OLED display, rotary
+ * @brief Initializes the ESP Menu system, including the I2C or SPI bus, OLED display, rotary
  * encoders, and LVGL.
  * @return esp_err_t ESP_OK on success, or an error code on failure.
  */
@@ -77,6 +221,43 @@ esp_err_t esp_menu_init(void) {
 	init_menu_params();
 #endif
 
+#ifdef CONFIG_ESPMENU_DISPLAY_BUS_SPI
+	// Initialize SPI bus for OLED display; transfers use DMA
+	ESP_LOGI(TAG, "Initializing SPI: SCLK=%d, MOSI=%d, CS=%d, DC=%d, RST=%d, %d MHz",
+			 CONFIG_ESPMENU_DISPLAY_SPI_SCLK, CONFIG_ESPMENU_DISPLAY_SPI_MOSI,
+			 CONFIG_ESPMENU_DISPLAY_SPI_CS, CONFIG_ESPMENU_DISPLAY_SPI_DC,
+			 CONFIG_ESPMENU_DISPLAY_SPI_RST, CONFIG_ESPMENU_DISPLAY_SPI_CLOCK_MHZ);
+
+	spi_host_device_t spi_host = (spi_host_device_t)CONFIG_ESPMENU_DISPLAY_SPI_HOST;
+	spi_bus_config_t spi_bus_config = {
+		.sclk_io_num = CONFIG_ESPMENU_DISPLAY_SPI_SCLK,
+		.mosi_io_num = CONFIG_ESPMENU_DISPLAY_SPI_MOSI,
+		.miso_io_num = -1,
+		.quadwp_io_num = -1,
+		.quadhd_io_num = -1,
+		.max_transfer_sz = CONFIG_ESPMENU_DISPLAY_WIDTH * CONFIG_ESPMENU_DISPLAY_HEIGHT / 8,
+	};
+	BSP_ERROR_CHECK_RETURN_ERR(spi_bus_initialize(spi_host, &spi_bus_config, SPI_DMA_CH_AUTO));
+	s_spi_host = spi_host;
+
+	// Initialize LCD panel I/O
+	esp_lcd_panel_io_handle_t io_handle = NULL;
+	esp_lcd_panel_io_spi_config_t io_config = {
+		.cs_gpio_num = CONFIG_ESPMENU_DISPLAY_SPI_CS,
+		.dc_gpio_num = CONFIG_ESPMENU_DISPLAY_SPI_DC,
+		.spi_mode = 0,
+		.pclk_hz = CONFIG_ESPMENU_DISPLAY_SPI_CLOCK_MHZ * 1000 * 1000,
+		.trans_queue_depth = CONFIG_ESPMENU_DISPLAY_TRANS_QUEUE_DEPTH,
+		.lcd_cmd_bits = 8,
+		.lcd_param_bits = 8,
+		// Command parameters are command bytes to these controllers
+		.flags.dc_low_on_param = 1,
+	};
+	BSP_ERROR_CHECK_RETURN_ERR(
+		esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)spi_host, &io_config, &io_handle));
+	s_io_handle = io_handle;
+	const int reset_gpio = CONFIG_ESPMENU_DISPLAY_SPI_RST;
+#else
 	// Initialize I2C master bus for OLED display
 	ESP_LOGI(TAG, "Initializing I2C: SDA=%d, SCL=%d, Host=%d, Address=0x%02X",
 			 CONFIG_ESPMENU_DISPLAY_I2C_SDA, CONFIG_ESPMENU_DISPLAY_I2C_SCL,
@@ -116,50 +297,53 @@ esp_err_t esp_menu_init(void) {
 	BSP_ERROR_CHECK_RETURN_ERR(
 		esp_lcd_new_panel_io_i2c(i2c_bus, &io_config, &io_handle));
 	s_io_handle = io_handle;
+	const int reset_gpio = -1;
+#endif
 
 	// Initialize OLED panel
 	esp_lcd_panel_handle_t panel_handle = NULL;
-	esp_lcd_panel_dev_config_t panel_config = {.reset_gpio_num = -1,
+	esp_lcd_panel_dev_config_t panel_config = {.reset_gpio_num = reset_gpio,
 											   .bits_per_pixel = 1
 											  };
 
 #ifdef CONFIG_ESPMENU_DISPLAY_SSD1306
+	esp_lcd_panel_ssd1306_config_t ssd1306_config = {
+		.height = CONFIG_ESPMENU_DISPLAY_HEIGHT,
+	};
+	panel_config.vendor_config = &ssd1306_config;
 	BSP_ERROR_CHECK_RETURN_ERR(
 		esp_lcd_new_panel_ssd1306(io_handle, &panel_config, &panel_handle));
 #elif defined(CONFIG_ESPMENU_DISPLAY_SH1107)
-	// Note: SH1107 support would require external component or custom
-	//
-	// implementation
-	ESP_LOGW(TAG, "SH1107 display not yet supported in ESP-IDF. Using SSD1306 "
-				  "compatibility mode.");
+	esp_menu_sh1107_config_t sh1107_config = {
+		.width = CONFIG_ESPMENU_DISPLAY_WIDTH,
+		.height = CONFIG_ESPMENU_DISPLAY_HEIGHT,
+	};
+	panel_config.vendor_config = &sh1107_config;
 	BSP_ERROR_CHECK_RETURN_ERR(
-		esp_lcd_new_panel_ssd1306(io_handle, &panel_config, &panel_handle));
+		esp_menu_new_panel_sh1107(io_handle, &panel_config, &panel_handle));
 #else
 #error "No display type selected in menuconfig"
 #endif
 	BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_panel_reset(panel_handle));
 	BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_panel_init(panel_handle));
 
-	// Turn on the display - SSD1306 needs explicit activation
+	// Turn on the display - SSD1306 and SH1107 need explicit activation
 	BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_panel_disp_on_off(panel_handle, true));
 	ESP_LOGI(TAG, "Display turned on");
 
-	// Set display contrast to maximum (for SSD1306)
-#if defined(CONFIG_ESPMENU_DISPLAY_SSD1306)
-	// Set contrast to max (0xFF) using the public panel I/O API
-	uint8_t contrast_value = 0xFF;
+	// Set display contrast; 0x81 is shared by SSD1306 and SH1107
+	uint8_t contrast_value = CONFIG_ESPMENU_DISPLAY_CONTRAST;
 	esp_err_t err =
 		esp_lcd_panel_io_tx_param(io_handle, 0x81, &contrast_value, 1);
 	if (err != ESP_OK) {
 		ESP_LOGW(TAG, "Failed to set contrast: %s", esp_err_to_name(err));
 	} else {
-		ESP_LOGI(TAG, "Display contrast set to maximum");
+		ESP_LOGI(TAG, "Display contrast set to %u", contrast_value);
 	}
-#endif
 
 	lcd_handle = panel_handle;
 
-	ESP_LOGI(TAG, "Display size: %dx%d", 128, CONFIG_ESPMENU_DISPLAY_HEIGHT);
+	ESP_LOGI(TAG, "Display size: %dx%d", CONFIG_ESPMENU_DISPLAY_WIDTH, CONFIG_ESPMENU_DISPLAY_HEIGHT);
 
 // Define number of encoders based on config
 #if defined(CONFIG_ESPMENU_ROTARY_ENCODER_CNT_4)
@@ -218,239 +402,154 @@ esp_err_t esp_menu_init(void) {
 		button_gpio_config_t gpio_btn_cfg = {
 			.gpio_num = encoder_pins[i][2],
 			.active_level = 0, // Assuming active low buttons
-			.enable_power_save = false,
+			.enable_power_save = INPUT_POWER_SAVE,
 			.disable_pull = false,
 		};
 
 		ESP_LOGI(TAG, "Creating button on GPIO %d", encoder_pins[i][2]);
 		BSP_ERROR_CHECK_RETURN_ERR(iot_button_new_gpio_device(
 									   &btn_cfg, &gpio_btn_cfg, &encoder_btn_handles[i]));
+		BSP_ERROR_CHECK_RETURN_ERR(iot_button_register_cb(
+									   encoder_btn_handles[i], BUTTON_PRESS_DOWN, NULL,
+									   encoder_btn_wake_cb, NULL));
 	}
 
-	ESP_LOGI(TAG, "Button 0 created, knob will be created by LVGL port");
+	ESP_LOGI(TAG, "Buttons created");
+#ifdef CONFIG_ESPMENU_POWER_SAVE
+	// The knob and button drivers arm their pins with gpio_wakeup_enable()
+	BSP_ERROR_CHECK_RETURN_ERR(esp_sleep_enable_gpio_wakeup());
+#endif
 
 	// Initialize LVGL
 	lvgl_port_cfg_t lvgl_cfg = {
-		.task_priority = 5,
-		.task_stack = 8192, // Increased from 4096 to prevent stack overflow
+		.task_priority = CONFIG_ESPMENU_LVGL_TASK_PRIORITY,
+		.task_stack = CONFIG_ESPMENU_LVGL_TASK_STACK,
 		.task_affinity = -1,
-		.task_max_sleep_ms = 500,
-		.timer_period_ms = 5
+		.task_max_sleep_ms = CONFIG_ESPMENU_LVGL_MAX_SLEEP_MS,
+		.timer_period_ms = CONFIG_ESPMENU_LVGL_TICK_MS
 	};
 	BSP_ERROR_CHECK_RETURN_ERR(lvgl_port_init(&lvgl_cfg));
 
 	ESP_LOGI(TAG, "Starting LVGL task");
 
 	// Add display to LVGL
+#ifdef CONFIG_ESPMENU_DISPLAY_BUF_SPIRAM
+	const uint32_t disp_buf_caps = MALLOC_CAP_SPIRAM;
+#else
+	const uint32_t disp_buf_caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA;
+#endif
+#ifdef CONFIG_ESPMENU_DISPLAY_DOUBLE_BUFFER
+	const bool disp_double_buffer = true;
+#else
+	const bool disp_double_buffer = false;
+#endif
+	size_t heap_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+#ifdef CONFIG_ESPMENU_DISPLAY_DIFF_FLUSH
+	esp_menu_display_config_t disp_cfg = {
+		.io = io_handle,
+		.panel = panel_handle,
+		.hres = CONFIG_ESPMENU_DISPLAY_WIDTH,
+		.vres = CONFIG_ESPMENU_DISPLAY_HEIGHT,
+#ifdef CONFIG_ESPMENU_DISPLAY_BUF_PARTIAL
+		.buf_lines = CONFIG_ESPMENU_DISPLAY_BUF_LINES,
+#endif
+		.double_buffer = disp_double_buffer,
+		.buf_caps = disp_buf_caps,
+#ifdef CONFIG_ESPMENU_DISPLAY_ASYNC_FLUSH
+		.queue_depth = CONFIG_ESPMENU_DISPLAY_TRANS_QUEUE_DEPTH,
+		.task_priority = CONFIG_ESPMENU_DISPLAY_FLUSH_TASK_PRIORITY,
+		.task_stack = CONFIG_ESPMENU_DISPLAY_FLUSH_TASK_STACK,
+#endif
+	};
+	lvgl_port_lock(0);
+	lv_disp_t *disp = esp_menu_display_create(&disp_cfg);
+	lvgl_port_unlock();
+#else
+	// esp_lvgl_port needs a full-frame buffer (in pixels) for monochrome panels
 	lvgl_port_display_cfg_t disp_cfg = {
 		.io_handle = io_handle,
 		.panel_handle = panel_handle,
-		.buffer_size = 128 * CONFIG_ESPMENU_DISPLAY_HEIGHT,
-		.double_buffer = true,
-		.hres = 128,
+		.buffer_size = CONFIG_ESPMENU_DISPLAY_WIDTH * CONFIG_ESPMENU_DISPLAY_HEIGHT,
+		.double_buffer = disp_double_buffer,
+		.hres = CONFIG_ESPMENU_DISPLAY_WIDTH,
 		.vres = CONFIG_ESPMENU_DISPLAY_HEIGHT,
 		.monochrome = true,
-		.rotation = {.swap_xy = false, .mirror_x = false, .mirror_y = false}
+		.rotation = {.swap_xy = false, .mirror_x = false, .mirror_y = false},
+		.flags = {
+			.buff_dma = !(disp_buf_caps & MALLOC_CAP_SPIRAM),
+			.buff_spiram = !!(disp_buf_caps & MALLOC_CAP_SPIRAM),
+		},
 	};
 	lv_disp_t *disp = lvgl_port_add_disp(&disp_cfg);
+#endif
 	if (!disp) {
 		ESP_LOGE(TAG, "Failed to add display to LVGL");
 		return ESP_FAIL;
 	}
+	ESP_LOGI(TAG, "Display setup used %u bytes of heap",
+			 (unsigned)(heap_before - heap_caps_get_free_size(MALLOC_CAP_8BIT)));
 
 	// Focus the screen object once
 	lv_group_focus_obj(lv_scr_act());
 
-	// Register encoder using LVGL port for proper integration
-	for (int i = 0; i < encoder_count; i++) {
-		ESP_LOGI(TAG, "Setting up encoder %d (A:%d B:%d Button:%d)", i,
-				 encoder_pins[i][0], encoder_pins[i][1], encoder_pins[i][2]);
-
-		// Configure knob for LVGL port
-		knob_config_t knob_cfg = {
-			.default_direction = 0,
-			.gpio_encoder_a = encoder_pins[i][0],
-			.gpio_encoder_b = encoder_pins[i][1],
-			.enable_power_save = false,
-		};
-
-		// Configure LVGL port encoder
-		lvgl_port_encoder_cfg_t encoder_cfg = {
-			.disp = disp,
-			.encoder_a_b = &knob_cfg,
-			.encoder_enter =
-			encoder_btn_handles[i], // Use the button handle we created earlier
-		};
-
-		lv_indev_t *encoder_indev = lvgl_port_add_encoder(&encoder_cfg);
-		if (encoder_indev) {
-			ESP_LOGI(TAG, "Encoder %d registered with LVGL successfully", i);
-		} else {
-			ESP_LOGE(TAG, "Failed to register encoder %d with LVGL", i);
-			return ESP_FAIL;
-		}
-
-		// Only register the first encoder for now (most common case)
-		// Multiple encoders would need additional handling
-		if (i == 0) {
-			break;
-		}
+	// Encoder 1 drives menu navigation
+	ESP_LOGI(TAG, "Setting up encoder 1 (A:%d B:%d Button:%d)",
+			 encoder_pins[0][0], encoder_pins[0][1], encoder_pins[0][2]);
+	if (nav_encoder_create(disp, encoder_pins[0][0], encoder_pins[0][1],
+						   encoder_btn_handles[0]) != ESP_OK) {
+		ESP_LOGE(TAG, "Failed to register encoder 1 with LVGL");
+		return ESP_FAIL;
 	}
+	ESP_LOGI(TAG, "Encoder 1 registered with LVGL successfully");
 
-	// Initialize menu widgets
-	ESP_LOGI(TAG, "Initializing generated LVGL menu system");
-	menu_init(); // Use generated menu initialization
+	// Encoders 2-4 bypass LVGL input handling and drive parameters directly
+	for (int i = 1; i < encoder_count; i++) {
+		BSP_ERROR_CHECK_RETURN_ERR(esp_menu_direct_add(
+									   i - 1, encoder_pins[i][0], encoder_pins[i][1],
+									   encoder_btn_handles[i]));
+	}
 
-	// Fix group focus and activation for encoder navigation
 	lvgl_port_lock(0);
 
-	// The generated menu creates a group but doesn't set it as default
-	// Find the encoder input device to get its group
-	lv_indev_t *encoder_indev = lv_indev_get_next(NULL);
-	lv_group_t *encoder_group = NULL;
+	// Make the encoder's group the default so the menu engine can attach the
+	// visible screen's items to it
+	lv_group_set_default(lv_indev_get_group(s_nav_indev));
 
-	while (encoder_indev) {
-		if (lv_indev_get_type(encoder_indev) == LV_INDEV_TYPE_ENCODER) {
-			encoder_group = lv_indev_get_group(encoder_indev);
-			break;
-		}
-		encoder_indev = lv_indev_get_next(encoder_indev);
+	// Initialize menu widgets
+	ESP_LOGI(TAG, "Initializing generated LVGL menu system");
+	menu_init(); // Builds screens from the generated menu tree
+	esp_err_t direct_err = esp_menu_direct_start();
+	if (direct_err == ESP_OK) {
+		direct_err = esp_menu_idle_start(disp);
 	}
-
-	if (encoder_group) {
-		ESP_LOGI(TAG, "Found encoder group, setting as default");
-		lv_group_set_default(encoder_group);
-
-		// Find the main list and add all its buttons to the group for proper
-		// navigation
-		lv_obj_t *main_screen = lv_scr_act();
-		lv_obj_t *list_main = lv_obj_get_child(main_screen, 0);
-
-		if (list_main) {
-			ESP_LOGI(TAG, "Adding list buttons to encoder group");
-			uint32_t child_count = lv_obj_get_child_cnt(list_main);
-			ESP_LOGI(TAG, "Found %d children in main list", (int)child_count);
-
-			// Add each child to the group (they should be clickable list items)
-			for (uint32_t i = 0; i < child_count; i++) {
-				lv_obj_t *child = lv_obj_get_child(list_main, i);
-				if (child) {
-					// Check if the object can receive input events (is clickable)
-					if (lv_obj_has_flag(child, LV_OBJ_FLAG_CLICKABLE)) {
-						lv_group_add_obj(encoder_group, child);
-						ESP_LOGI(TAG, "Added clickable item %d to encoder group", (int)i);
-					}
-				}
-			}
-
-			// Focus the first clickable item if available
-			if (child_count > 0) {
-				lv_obj_t *first_item = lv_obj_get_child(list_main, 0);
-				if (first_item && lv_obj_has_flag(first_item, LV_OBJ_FLAG_CLICKABLE)) {
-					lv_group_focus_obj(first_item);
-					ESP_LOGI(TAG, "Set focus to first clickable item");
-				}
-			}
-		}
-
-		// Force layout update and redraw
-		lv_obj_update_layout(lv_scr_act());
-		lv_obj_invalidate(lv_scr_act());
-
-	} else {
-		ESP_LOGW(TAG, "No encoder group found - creating fallback group");
-		// Create a fallback group if none exists
-		lv_group_t *fallback_group = lv_group_create();
-		lv_group_set_default(fallback_group);
-
-		// Find the main screen list and add it to the group
-		lv_obj_t *list = lv_obj_get_child(lv_scr_act(), 0);
-		if (list) {
-			lv_group_add_obj(fallback_group, list);
-			lv_group_focus_obj(list);
-		}
+	if (direct_err == ESP_OK) {
+		direct_err = esp_menu_saver_start(disp, io_handle, panel_handle);
 	}
 
-			// Add runtime styles to improve focus visibility and spacing on monochrome OLED
-			do {
-				static lv_style_t s_focus_style;
-				static lv_style_t s_normal_style;
-				static bool styles_inited = false;
-				if (!styles_inited) {
-					lv_style_init(&s_focus_style);
-					lv_style_set_bg_opa(&s_focus_style, LV_OPA_COVER);
-					lv_style_set_bg_color(&s_focus_style, lv_color_white());
-					lv_style_set_text_color(&s_focus_style, lv_color_black());
-					lv_style_set_border_width(&s_focus_style, 2);
-					lv_style_set_border_color(&s_focus_style, lv_color_black());
-					lv_style_set_outline_width(&s_focus_style, 1);
-					lv_style_set_outline_color(&s_focus_style, lv_color_black());
-					lv_style_set_pad_all(&s_focus_style, 2);
-
-					lv_style_init(&s_normal_style);
-					lv_style_set_pad_all(&s_normal_style, 1);
-					// Enforce a minimum item height for consistent spacing
-					lv_style_set_min_height(&s_normal_style, 14);
-					styles_inited = true;
-				}
-
-				// Apply to the first list on the active screen
-				lv_obj_t *list = lv_obj_get_child(lv_scr_act(), 0);
-				if (list) {
-					lv_obj_add_style(list, &s_focus_style, LV_PART_ITEMS | LV_STATE_FOCUSED);
-					lv_obj_add_style(list, &s_normal_style, LV_PART_ITEMS);
-					lv_obj_update_layout(list);
-				}
-			} while (0);
-
 	lvgl_port_unlock();
+	BSP_ERROR_CHECK_RETURN_ERR(direct_err);
 
-	// Improve focus visibility and spacing at runtime (monochrome-friendly)
-	lvgl_port_lock(0);
-	lv_obj_t *act = lv_scr_act();
-	if (act) {
-	  // Try to find the main list as first child
-	  lv_obj_t *list = lv_obj_get_child(act, 0);
-	  if (list) {
-		static lv_style_t style_focus_rt;
-		static bool style_inited = false;
-		if (!style_inited) {
-		  style_inited = true;
-		  lv_style_init(&style_focus_rt);
-		  lv_style_set_bg_opa(&style_focus_rt, LV_OPA_COVER);
-		  lv_style_set_bg_color(&style_focus_rt, lv_color_white());
-		  lv_style_set_text_color(&style_focus_rt, lv_color_black());
-		  lv_style_set_border_width(&style_focus_rt, 2);
-		  lv_style_set_border_color(&style_focus_rt, lv_color_black());
-		  lv_style_set_outline_width(&style_focus_rt, 1);
-		  lv_style_set_outline_color(&style_focus_rt, lv_color_black());
-		  lv_style_set_pad_top(&style_focus_rt, 2);
-		  lv_style_set_pad_bottom(&style_focus_rt, 2);
-		  lv_style_set_pad_left(&style_focus_rt, 4);
-		  lv_style_set_pad_right(&style_focus_rt, 4);
-    
-				lv_obj_add_style(list, &style_focus_rt, LV_PART_ITEMS | LV_STATE_FOCUSED);
-				}
-				// Normalize spacing for all items
-				uint32_t n = lv_obj_get_child_cnt(list);
-				for (uint32_t i = 0; i < n; i++) {
-					lv_obj_t *child = lv_obj_get_child(list, i);
-					if (child && lv_obj_has_flag(child, LV_OBJ_FLAG_CLICKABLE)) {
-						lv_obj_set_style_pad_top(child, 1, 0);
-						lv_obj_set_style_pad_bottom(child, 1, 0);
-						lv_obj_set_style_pad_left(child, 4, 0);
-						lv_obj_set_style_pad_right(child, 4, 0);
-					}
-				}
-				lv_obj_update_layout(list);
-				lv_obj_invalidate(list);
-			}
-		}
+#ifdef CONFIG_ESPMENU_ENABLE_NVS
+	// Restore saved parameters and start write-behind persistence
+	esp_err_t store_err = esp_menu_store_init();
+	if (store_err != ESP_OK) {
+		ESP_LOGW(TAG, "Parameter persistence unavailable: %s", esp_err_to_name(store_err));
+	} else {
+		lvgl_port_lock(0);
+		esp_menu_engine_refresh();
 		lvgl_port_unlock();
+	}
+#ifdef CONFIG_ESPMENU_PRESETS
+	esp_err_t preset_err = esp_menu_preset_init();
+	if (preset_err != ESP_OK) {
+		ESP_LOGW(TAG, "Preset bank unavailable: %s", esp_err_to_name(preset_err));
+	}
+#endif
+#endif
 
-		ESP_LOGI(TAG, "Menu system fully initialized");
-		s_initialized = true;
-		return ESP_OK;
+	ESP_LOGI(TAG, "Menu system fully initialized");
+	s_initialized = true;
+	return ESP_OK;
 }
 
 esp_err_t esp_menu_deinit(void) {
@@ -459,9 +558,18 @@ esp_err_t esp_menu_deinit(void) {
 			return ESP_OK;
 		}
 
+		// Flush pending parameter changes before tearing anything down
+		esp_menu_store_deinit();
+		esp_menu_preset_deinit();
+
 		// Stop LVGL port and delete display/encoder if possible
 		// There is no explicit lvgl_port_deinit API; perform best-effort cleanup.
 		lvgl_port_lock(0);
+		esp_menu_saver_stop();
+		esp_menu_idle_stop();
+		nav_encoder_delete();
+		esp_menu_direct_stop();
+		esp_menu_engine_stop();
 		lv_display_t * disp = lv_disp_get_default();
 		if(disp) {
 			lv_display_delete(disp);
@@ -484,6 +592,10 @@ esp_err_t esp_menu_deinit(void) {
 			i2c_del_master_bus(s_i2c_bus);
 			s_i2c_bus = NULL;
 		}
+		if(s_spi_host >= 0) {
+			spi_bus_free((spi_host_device_t)s_spi_host);
+			s_spi_host = -1;
+		}
 
 		s_initialized = false;
 		return ESP_OK;
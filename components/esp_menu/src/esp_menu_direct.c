@@ -0,0 +1,231 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_direct.c
+ * @brief Direct-control encoders that update parameters without LVGL input processing.
+ */
+
+#include "esp_menu_direct.h"
+#include "esp_log.h"
+#include "esp_menu.h"
+#include "esp_menu_engine.h"
+#include "esp_menu_latency.h"
+#include "esp_menu_param.h"
+#include "esp_menu_saver.h"
+#include "esp_menu_trace.h"
+#include "iot_knob.h"
+#include "lvgl.h"
+#include "sdkconfig.h"
+#include <stdio.h>
+
+/** @brief Logging tag for direct-control encoders. */
+#define TAG "Esp_menu_direct"
+
+#ifdef CONFIG_ESPMENU_DIRECT_OVERLAY_MS
+#define DIRECT_OVERLAY_MS CONFIG_ESPMENU_DIRECT_OVERLAY_MS
+#else
+#define DIRECT_OVERLAY_MS 1000
+#endif
+
+/** @brief State of one direct-control encoder. */
+typedef struct {
+	knob_handle_t knob;
+	button_handle_t button;
+	esp_menu_accel_state_t accel;  ///< Detent timing, touched only by the knob callback
+	uint16_t binding;              ///< Parameter ID, ESP_MENU_DIRECT_FOLLOW or ESP_MENU_NO_PARAM
+	uint16_t pending;              ///< Parameter to redraw on the next frame, ESP_MENU_NO_PARAM if none
+} direct_knob_t;
+
+static direct_knob_t s_knobs[ESP_MENU_DIRECT_MAX] = {
+	[0 ... ESP_MENU_DIRECT_MAX - 1] = {
+		.binding = ESP_MENU_DIRECT_FOLLOW,
+		.pending = ESP_MENU_NO_PARAM,
+	},
+};
+
+/** @brief Per-frame timer that applies pending redraws in the LVGL task. */
+static lv_timer_t *s_timer = NULL;
+/** @brief Overlay label on the top layer showing the parameter being turned. */
+static lv_obj_t *s_overlay = NULL;
+/** @brief Tick at which the overlay was last updated. */
+static uint32_t s_overlay_tick = 0;
+
+uint16_t esp_menu_direct_get_param(uint8_t index) {
+	if (index >= ESP_MENU_DIRECT_MAX) {
+		return ESP_MENU_NO_PARAM;
+	}
+	uint16_t binding = s_knobs[index].binding;
+	if (binding == ESP_MENU_DIRECT_FOLLOW) {
+		return esp_menu_engine_screen_param(index);
+	}
+	return binding;
+}
+
+/**
+ * @brief Queue a redraw of @p param and wake the LVGL task so it lands on the next frame.
+ */
+static void direct_post(direct_knob_t *knob, uint16_t param) {
+	__atomic_store_n(&knob->pending, param, __ATOMIC_RELEASE);
+	esp_menu_notify_update();
+}
+
+/**
+ * @brief Apply detents to the bound parameter; runs in the knob's timer context.
+ */
+static void direct_turn(direct_knob_t *knob, int32_t detents) {
+	esp_menu_latency_input();
+	ESP_MENU_TRACE_INSTANT(ESP_MENU_TRACE_INPUT, knob - s_knobs + 1);
+	esp_menu_saver_activity();
+	uint16_t param = esp_menu_direct_get_param((uint8_t)(knob - s_knobs));
+	if (param == ESP_MENU_NO_PARAM) {
+		return;
+	}
+	int32_t steps = esp_menu_param_accel(param, &knob->accel, detents);
+	if (esp_menu_param_step(param, steps)) {
+		direct_post(knob, param);
+	}
+}
+
+static void direct_knob_right_cb(void *arg, void *data) {
+	(void)arg;
+	direct_turn(data, 1);
+}
+
+static void direct_knob_left_cb(void *arg, void *data) {
+	(void)arg;
+	direct_turn(data, -1);
+}
+
+/**
+ * @brief Button click: show the bound parameter without changing it.
+ */
+static void direct_button_cb(void *arg, void *data) {
+	(void)arg;
+	direct_knob_t *knob = data;
+	uint16_t param = esp_menu_direct_get_param((uint8_t)(knob - s_knobs));
+	if (param != ESP_MENU_NO_PARAM) {
+		direct_post(knob, param);
+	}
+}
+
+/**
+ * @brief Show "Label: value" of @p param in the overlay.
+ */
+static void direct_overlay_show(uint16_t param) {
+	const esp_menu_param_desc_t *desc = esp_menu_param_get_desc(param);
+	if (!s_overlay || !desc) {
+		return;
+	}
+	char value[24];
+	char text[40];
+	esp_menu_param_format(param, value, sizeof(value));
+	snprintf(text, sizeof(text), "%s: %s", desc->label, value);
+	lv_label_set_text(s_overlay, text);
+	lv_obj_remove_flag(s_overlay, LV_OBJ_FLAG_HIDDEN);
+	s_overlay_tick = lv_tick_get();
+}
+
+/**
+ * @brief Drain pending redraws once per frame and hide the overlay when idle.
+ */
+static void direct_timer_cb(lv_timer_t *timer) {
+	(void)timer;
+	for (uint8_t i = 0; i < ESP_MENU_DIRECT_MAX; i++) {
+		uint16_t param = __atomic_exchange_n(&s_knobs[i].pending, ESP_MENU_NO_PARAM,
+											 __ATOMIC_ACQUIRE);
+		if (param != ESP_MENU_NO_PARAM) {
+			// The parameter already changed in the knob callback; this is its read
+			esp_menu_latency_read();
+			esp_menu_engine_refresh_param(param);
+			direct_overlay_show(param);
+		}
+	}
+	if (s_overlay && !lv_obj_has_flag(s_overlay, LV_OBJ_FLAG_HIDDEN) &&
+		lv_tick_elaps(s_overlay_tick) >= DIRECT_OVERLAY_MS) {
+		lv_obj_add_flag(s_overlay, LV_OBJ_FLAG_HIDDEN);
+	}
+}
+
+esp_err_t esp_menu_direct_add(uint8_t index, int gpio_a, int gpio_b, button_handle_t button) {
+	if (index >= ESP_MENU_DIRECT_MAX || s_knobs[index].knob) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	direct_knob_t *knob = &s_knobs[index];
+	knob_config_t knob_cfg = {
+		.default_direction = 0,
+		.gpio_encoder_a = gpio_a,
+		.gpio_encoder_b = gpio_b,
+#ifdef CONFIG_ESPMENU_POWER_SAVE
+		.enable_power_save = true,
+#else
+		.enable_power_save = false,
+#endif
+	};
+	knob->knob = iot_knob_create(&knob_cfg);
+	if (!knob->knob) {
+		ESP_LOGE(TAG, "Failed to create knob for encoder %d", index + 2);
+		return ESP_FAIL;
+	}
+	iot_knob_register_cb(knob->knob, KNOB_RIGHT, direct_knob_right_cb, knob);
+	iot_knob_register_cb(knob->knob, KNOB_LEFT, direct_knob_left_cb, knob);
+	knob->button = button;
+	if (button) {
+		iot_button_register_cb(button, BUTTON_SINGLE_CLICK, NULL, direct_button_cb, knob);
+	}
+	ESP_LOGI(TAG, "Encoder %d is a direct control (A:%d B:%d)", index + 2, gpio_a, gpio_b);
+	return ESP_OK;
+}
+
+void esp_menu_direct_bind(uint8_t index, uint16_t param) {
+	if (index < ESP_MENU_DIRECT_MAX) {
+		__atomic_store_n(&s_knobs[index].binding, param, __ATOMIC_RELAXED);
+	}
+}
+
+esp_err_t esp_menu_direct_start(void) {
+	if (s_timer) {
+		return ESP_OK;
+	}
+#if DIRECT_OVERLAY_MS > 0
+	s_overlay = lv_label_create(lv_layer_top());
+	if (!s_overlay) {
+		return ESP_ERR_NO_MEM;
+	}
+	lv_obj_set_width(s_overlay, LV_PCT(100));
+	lv_obj_align(s_overlay, LV_ALIGN_BOTTOM_MID, 0, 0);
+	lv_obj_set_style_bg_opa(s_overlay, LV_OPA_COVER, 0);
+	lv_obj_set_style_bg_color(s_overlay, lv_color_white(), 0);
+	lv_obj_set_style_text_color(s_overlay, lv_color_black(), 0);
+	lv_obj_set_style_pad_hor(s_overlay, 2, 0);
+	lv_label_set_long_mode(s_overlay, LV_LABEL_LONG_DOT);
+	lv_obj_add_flag(s_overlay, LV_OBJ_FLAG_HIDDEN);
+#endif
+	s_timer = lv_timer_create(direct_timer_cb, LV_DEF_REFR_PERIOD, NULL);
+	if (!s_timer) {
+		esp_menu_direct_stop();
+		return ESP_ERR_NO_MEM;
+	}
+	return ESP_OK;
+}
+
+void esp_menu_direct_stop(void) {
+	for (uint8_t i = 0; i < ESP_MENU_DIRECT_MAX; i++) {
+		direct_knob_t *knob = &s_knobs[i];
+		if (knob->knob) {
+			iot_knob_delete(knob->knob);
+			knob->knob = NULL;
+		}
+		if (knob->button) {
+			iot_button_unregister_cb(knob->button, BUTTON_SINGLE_CLICK, NULL);
+			knob->button = NULL;
+		}
+		knob->pending = ESP_MENU_NO_PARAM;
+	}
+	if (s_timer) {
+		lv_timer_delete(s_timer);
+		s_timer = NULL;
+	}
+	if (s_overlay) {
+		lv_obj_delete(s_overlay);
+		s_overlay = NULL;
+	}
+}
@@ -0,0 +1,521 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_display.c
+ * @brief Page-diffing flush path for SSD1306-class monochrome panels.
+ */
+
+#include "esp_menu_display.h"
+#include "esp_menu_latency.h"
+#include "esp_menu_trace.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief Logging tag for the display. */
+#define TAG "Esp_menu_display"
+
+/** @brief Rows per GDDRAM page. */
+#define DISPLAY_PAGE_ROWS 8
+
+/** @brief Palette LVGL puts in front of I1 pixel data. */
+#define DISPLAY_PALETTE_SIZE 8
+
+/**
+ * @brief Unchanged bytes between two changed runs that are sent rather than split.
+ *
+ * Each span costs column and page addressing commands, two extra I2C
+ * transactions of about five bytes each, so shorter gaps are cheaper to send.
+ */
+#define DISPLAY_SPAN_MERGE_GAP 8
+
+/** @brief Span flag: no pixels, marks the end of a refresh. */
+#define DISPLAY_SPAN_END (1u << 0)
+/** @brief Span flag: stop the flush task. */
+#define DISPLAY_SPAN_EXIT (1u << 1)
+
+/** @brief Longest wait for the bus to drain at the end of a refresh. */
+#define DISPLAY_DRAIN_TIMEOUT_MS 200
+
+/** @brief Column run of one page queued to the flush task. */
+typedef struct {
+	uint16_t page;
+	uint16_t x0;
+	uint16_t x1;
+	uint16_t flags;       ///< DISPLAY_SPAN_* flags
+	uint32_t render_us;   ///< Render time of the refresh, with DISPLAY_SPAN_END
+	int64_t refr_start;   ///< Start of the refresh, with DISPLAY_SPAN_END
+	int64_t input_us;     ///< Input stamp the refresh shows, with DISPLAY_SPAN_END
+} display_span_t;
+
+/** @brief State of the one display. */
+typedef struct {
+	esp_lcd_panel_io_handle_t io;
+	esp_lcd_panel_handle_t panel;
+	uint16_t hres;
+	uint16_t vres;
+	uint8_t *draw_buf[2];  ///< LVGL render buffers, palette + I1 pixels
+	uint8_t *shadow;       ///< Copy of the panel's GDDRAM, hres bytes per page
+	atomic_int pending;    ///< Outstanding transfers; plus one for a synchronous flush in progress
+	uint32_t frame_bytes;  ///< Bytes sent so far in the current refresh
+	uint32_t frame_spans;  ///< Spans sent so far in the current refresh
+	uint32_t frame_area;   ///< Pixels flushed so far in the current refresh
+	QueueHandle_t spans;   ///< Spans for the flush task, NULL when flushing synchronously
+	TaskHandle_t task;     ///< Flush task
+	TaskHandle_t waiter;   ///< Task waiting for the flush task to exit
+	int64_t refr_start;    ///< Start of the current refresh
+	int64_t input_us;      ///< Input stamp claimed by the current refresh, 0 if none
+	int64_t mark;          ///< End of the last flush callback, start of rendering
+	int64_t render_acc;    ///< Render time of the current refresh, us
+	int64_t bus_acc;       ///< Synchronous bus time of the current refresh, us
+	esp_menu_display_stats_t stats;
+	portMUX_TYPE stats_mux;  ///< Keeps the 64-bit totals whole while the flush task adds to them
+	esp_menu_display_mem_t mem;
+} display_ctx_t;
+
+static display_ctx_t *s_ctx = NULL;
+/** @brief Serialises panel IO; created with the first display and kept, so it outlives every user. */
+static SemaphoreHandle_t s_io_lock = NULL;
+static StaticSemaphore_t s_io_lock_buf;
+
+void esp_menu_display_io_lock(void) {
+	if (s_io_lock) {
+		xSemaphoreTake(s_io_lock, portMAX_DELAY);
+	}
+}
+
+void esp_menu_display_io_unlock(void) {
+	if (s_io_lock) {
+		xSemaphoreGive(s_io_lock);
+	}
+}
+
+static bool display_trans_done(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata,
+							   void *user_ctx) {
+	lv_display_t *disp = (lv_display_t *)user_ctx;
+	display_ctx_t *ctx = s_ctx;
+	if (!ctx || atomic_fetch_sub(&ctx->pending, 1) != 1) {
+		return false;
+	}
+	if (!ctx->spans) {
+		lv_display_flush_ready(disp);
+		return false;
+	}
+	// The flush task waits for the bus to drain at the end of each refresh
+	BaseType_t woken = pdFALSE;
+	if (xPortInIsrContext()) {
+		vTaskNotifyGiveFromISR(ctx->task, &woken);
+	} else {
+		xTaskNotifyGive(ctx->task);
+	}
+	return woken == pdTRUE;
+}
+
+static esp_err_t display_draw_span(display_ctx_t *ctx, uint16_t page, uint16_t x0, uint16_t x1) {
+	atomic_fetch_add(&ctx->pending, 1);
+	esp_menu_display_io_lock();
+	esp_err_t err = esp_lcd_panel_draw_bitmap(ctx->panel, x0, page * DISPLAY_PAGE_ROWS, x1 + 1,
+											  (page + 1) * DISPLAY_PAGE_ROWS,
+											  &ctx->shadow[page * ctx->hres + x0]);
+	esp_menu_display_io_unlock();
+	if (err != ESP_OK) {
+		// No transfer was queued, so no completion will arrive for it
+		atomic_fetch_sub(&ctx->pending, 1);
+		ESP_LOGW(TAG, "draw_bitmap failed: %s", esp_err_to_name(err));
+	}
+	return err;
+}
+
+/**
+ * @brief Wait outside the flush path until every counted transfer has completed.
+ */
+static void display_wait_idle(display_ctx_t *ctx) {
+	int64_t deadline = esp_timer_get_time() + DISPLAY_DRAIN_TIMEOUT_MS * 1000LL;
+	while (atomic_load(&ctx->pending) > 0 && esp_timer_get_time() < deadline) {
+		vTaskDelay(1);
+	}
+	if (atomic_load(&ctx->pending) > 0) {
+		ESP_LOGW(TAG, "Bus did not drain; %d transfers outstanding", atomic_load(&ctx->pending));
+		atomic_store(&ctx->pending, 0);
+	}
+}
+
+static void display_send_span(display_ctx_t *ctx, uint16_t page, uint16_t x0, uint16_t x1) {
+	if (ctx->spans) {
+		const display_span_t span = {.page = page, .x0 = x0, .x1 = x1};
+		xQueueSend(ctx->spans, &span, portMAX_DELAY);
+	} else {
+		int64_t start = esp_timer_get_time();
+		esp_err_t err = display_draw_span(ctx, page, x0, x1);
+		ctx->bus_acc += esp_timer_get_time() - start;
+		if (err != ESP_OK) {
+			return;
+		}
+	}
+	uint32_t len = x1 - x0 + 1;
+	ctx->frame_bytes += len;
+	ctx->frame_spans++;
+	ctx->stats.bytes_sent += len;
+	ctx->stats.spans++;
+}
+
+/**
+ * @brief Send queued spans while LVGL renders the next area.
+ *
+ * Spans point into the shadow, which the LVGL task may update before a
+ * span is sent; the span then carries the newer bytes and the later span
+ * for the same columns repeats them, so the panel always ends up current.
+ */
+static void display_flush_task(void *arg) {
+	display_ctx_t *ctx = arg;
+	int64_t bus_start = 0;
+	display_span_t span;
+	for (;;) {
+		xQueueReceive(ctx->spans, &span, portMAX_DELAY);
+		if (span.flags & DISPLAY_SPAN_EXIT) {
+			break;
+		}
+		if (!bus_start) {
+			bus_start = esp_timer_get_time();
+			ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_BUS, 0);
+		}
+		if (!(span.flags & DISPLAY_SPAN_END)) {
+			display_draw_span(ctx, span.page, span.x0, span.x1);
+			continue;
+		}
+		while (atomic_load(&ctx->pending) > 0) {
+			if (!ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DISPLAY_DRAIN_TIMEOUT_MS))) {
+				ESP_LOGW(TAG, "Bus did not drain; %d transfers outstanding", atomic_load(&ctx->pending));
+				atomic_store(&ctx->pending, 0);
+			}
+		}
+		ESP_MENU_TRACE_END(ESP_MENU_TRACE_BUS, 0);
+		int64_t now = esp_timer_get_time();
+		taskENTER_CRITICAL(&ctx->stats_mux);
+		ctx->stats.last_bus_us = now - bus_start;
+		ctx->stats.last_frame_us = now - span.refr_start;
+		ctx->stats.bus_us_total += ctx->stats.last_bus_us;
+		taskEXIT_CRITICAL(&ctx->stats_mux);
+		esp_menu_latency_frame(span.input_us, span.render_us, ctx->stats.last_bus_us);
+		bus_start = 0;
+	}
+	xTaskNotifyGive(ctx->waiter);
+	vTaskDelete(NULL);
+}
+
+/**
+ * @brief Transpose one 8x8 tile of I1 rows into eight GDDRAM column bytes.
+ *
+ * 8x8 bit-matrix transpose on two 32-bit words (Hacker's Delight 7-3). Rows
+ * are loaded bottom first so that row n lands in bit n of each column byte.
+ * A set LVGL bit is shown as an unlit pixel, the same polarity as
+ * esp_lvgl_port, hence the final inversion.
+ */
+static inline void display_transpose8(const uint8_t *src, uint32_t stride, uint8_t *dst) {
+	uint32_t x = ((uint32_t)src[7 * stride] << 24) | ((uint32_t)src[6 * stride] << 16) |
+				 ((uint32_t)src[5 * stride] << 8) | src[4 * stride];
+	uint32_t y = ((uint32_t)src[3 * stride] << 24) | ((uint32_t)src[2 * stride] << 16) |
+				 ((uint32_t)src[stride] << 8) | src[0];
+	uint32_t t;
+
+	t = (x ^ (x >> 7)) & 0x00AA00AA;
+	x = x ^ t ^ (t << 7);
+	t = (y ^ (y >> 7)) & 0x00AA00AA;
+	y = y ^ t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000CCCC;
+	x = x ^ t ^ (t << 14);
+	t = (y ^ (y >> 14)) & 0x0000CCCC;
+	y = y ^ t ^ (t << 14);
+	t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+	y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+	x = ~t;
+	y = ~y;
+
+	dst[0] = x >> 24;
+	dst[1] = x >> 16;
+	dst[2] = x >> 8;
+	dst[3] = x;
+	dst[4] = y >> 24;
+	dst[5] = y >> 16;
+	dst[6] = y >> 8;
+	dst[7] = y;
+}
+
+void esp_menu_display_pack_page(const uint8_t *px, uint32_t stride, uint16_t width, uint8_t *out) {
+	uint16_t x = 0;
+	for (; x + 8 <= width; x += 8) {
+		display_transpose8(&px[x >> 3], stride, &out[x]);
+	}
+	if (x < width) {
+		uint8_t tile[8];
+		display_transpose8(&px[x >> 3], stride, tile);
+		memcpy(&out[x], tile, width - x);
+	}
+}
+
+/** @brief Convert one page of the flushed area tile by tile and send the columns that changed. */
+static void display_flush_page(display_ctx_t *ctx, uint16_t page, const lv_area_t *area,
+							   const uint8_t *px, uint32_t stride) {
+	uint8_t *row = &ctx->shadow[page * ctx->hres];
+	const uint8_t *src = &px[(page * DISPLAY_PAGE_ROWS - area->y1) * stride];
+	int32_t width = lv_area_get_width(area);
+	int32_t run_start = -1;
+	int32_t run_end = -1;
+
+	for (int32_t bx = 0; bx < width; bx += 8) {
+		uint8_t tile[8];
+		display_transpose8(&src[bx >> 3], stride, tile);
+		int32_t n = width - bx < 8 ? width - bx : 8;
+		for (int32_t i = 0; i < n; i++) {
+			int32_t x = area->x1 + bx + i;
+			if (row[x] == tile[i]) {
+				continue;
+			}
+			row[x] = tile[i];
+			if (run_start >= 0 && x - run_end - 1 > DISPLAY_SPAN_MERGE_GAP) {
+				display_send_span(ctx, page, run_start, run_end);
+				run_start = -1;
+			}
+			if (run_start < 0) {
+				run_start = x;
+			}
+			run_end = x;
+		}
+	}
+	if (run_start >= 0) {
+		display_send_span(ctx, page, run_start, run_end);
+	}
+}
+
+static void display_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
+	display_ctx_t *ctx = lv_display_get_driver_data(disp);
+	const uint8_t *px = px_map + DISPLAY_PALETTE_SIZE;
+	uint32_t stride = lv_draw_buf_width_to_stride(lv_area_get_width(area), LV_COLOR_FORMAT_I1);
+	ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_FLUSH, lv_area_get_size(area));
+	int64_t flush_start = esp_timer_get_time();
+	int64_t bus_before = ctx->bus_acc;
+	ctx->render_acc += flush_start - ctx->mark;
+
+	if (!ctx->spans) {
+		atomic_store(&ctx->pending, 1);
+	}
+	uint32_t sent = ctx->frame_bytes;
+	uint16_t pages = 0;
+	for (uint16_t page = area->y1 / DISPLAY_PAGE_ROWS; page <= area->y2 / DISPLAY_PAGE_ROWS; page++) {
+		display_flush_page(ctx, page, area, px, stride);
+		pages++;
+	}
+	ctx->stats.bytes_skipped += pages * lv_area_get_width(area) - (ctx->frame_bytes - sent);
+	ctx->frame_area += lv_area_get_size(area);
+
+	// Conversion counts as rendering; synchronous bus time does not
+	ctx->mark = esp_timer_get_time();
+	ctx->render_acc += ctx->mark - flush_start - (ctx->bus_acc - bus_before);
+	ESP_MENU_TRACE_END(ESP_MENU_TRACE_FLUSH, lv_area_get_size(area));
+
+	if (lv_display_flush_is_last(disp)) {
+		ctx->stats.frames++;
+		ctx->stats.last_frame_bytes = ctx->frame_bytes;
+		ctx->stats.last_frame_spans = ctx->frame_spans;
+		ctx->stats.last_render_us = ctx->render_acc;
+		ctx->stats.render_us_total += ctx->stats.last_render_us;
+		ctx->stats.last_frame_area_px = ctx->frame_area;
+		ctx->stats.area_px += ctx->frame_area;
+		ESP_MENU_TRACE_END(ESP_MENU_TRACE_RENDER, ctx->frame_area);
+		ctx->frame_area = 0;
+		ctx->frame_bytes = 0;
+		ctx->frame_spans = 0;
+		ctx->render_acc = 0;
+		if (ctx->spans) {
+			const display_span_t end = {
+				.flags = DISPLAY_SPAN_END,
+				.render_us = ctx->stats.last_render_us,
+				.refr_start = ctx->refr_start,
+				.input_us = ctx->input_us,
+			};
+			xQueueSend(ctx->spans, &end, portMAX_DELAY);
+		} else {
+			ctx->stats.last_bus_us = ctx->bus_acc;
+			ctx->stats.last_frame_us = ctx->mark - ctx->refr_start;
+			ctx->stats.bus_us_total += ctx->stats.last_bus_us;
+			esp_menu_latency_frame(ctx->input_us, ctx->stats.last_render_us, ctx->stats.last_bus_us);
+			ctx->bus_acc = 0;
+		}
+	}
+
+	if (ctx->spans) {
+		// The area is in the shadow now, so LVGL may render the next one into this buffer
+		lv_display_flush_ready(disp);
+		return;
+	}
+	// Drop the flush's own reference; the last transfer may already be done
+	if (atomic_fetch_sub(&ctx->pending, 1) == 1) {
+		lv_display_flush_ready(disp);
+	}
+}
+
+static void display_render_start_cb(lv_event_t *e) {
+	display_ctx_t *ctx = lv_event_get_user_data(e);
+	ctx->refr_start = esp_timer_get_time();
+	ctx->mark = ctx->refr_start;
+	ctx->input_us = esp_menu_latency_claim();
+	ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_RENDER, 0);
+}
+
+/** @brief Widen invalidated areas to whole pages so every flush is page aligned. */
+static void display_rounder_cb(lv_event_t *e) {
+	lv_area_t *area = lv_event_get_param(e);
+	area->y1 &= ~(DISPLAY_PAGE_ROWS - 1);
+	area->y2 |= DISPLAY_PAGE_ROWS - 1;
+}
+
+static void display_free(display_ctx_t *ctx) {
+	if (ctx->spans) {
+		vQueueDelete(ctx->spans);
+	}
+	heap_caps_free(ctx->draw_buf[0]);
+	heap_caps_free(ctx->draw_buf[1]);
+	heap_caps_free(ctx->shadow);
+	free(ctx);
+}
+
+static void display_delete_cb(lv_event_t *e) {
+	display_ctx_t *ctx = lv_event_get_user_data(e);
+	if (ctx->task) {
+		const display_span_t exit = {.flags = DISPLAY_SPAN_EXIT};
+		ctx->waiter = xTaskGetCurrentTaskHandle();
+		xQueueSend(ctx->spans, &exit, portMAX_DELAY);
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+	const esp_lcd_panel_io_callbacks_t cbs = {0};
+	esp_lcd_panel_io_register_event_callbacks(ctx->io, &cbs, NULL);
+	s_ctx = NULL;
+	display_free(ctx);
+}
+
+lv_display_t *esp_menu_display_create(const esp_menu_display_config_t *config) {
+	if (s_ctx || !config || !config->io || !config->panel || config->hres == 0 || config->vres == 0 ||
+			config->vres % DISPLAY_PAGE_ROWS) {
+		ESP_LOGE(TAG, "Invalid display configuration");
+		return NULL;
+	}
+	uint16_t hres = config->hres;
+	uint16_t vres = config->vres;
+	uint16_t lines = config->buf_lines & ~(DISPLAY_PAGE_ROWS - 1);
+	if (lines == 0 || lines > vres) {
+		lines = vres;
+	}
+
+	size_t frame_size = (size_t)hres * vres / 8;
+	size_t buf_size = lv_draw_buf_width_to_stride(hres, LV_COLOR_FORMAT_I1) * lines + DISPLAY_PALETTE_SIZE;
+	uint32_t caps = config->buf_caps ? config->buf_caps : MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+	int bufs = config->double_buffer ? 2 : 1;
+	display_ctx_t *ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		return NULL;
+	}
+	ctx->io = config->io;
+	ctx->panel = config->panel;
+	ctx->hres = hres;
+	ctx->vres = vres;
+	portMUX_INITIALIZE(&ctx->stats_mux);
+	bool ok = true;
+	for (int i = 0; i < bufs; i++) {
+		ctx->draw_buf[i] = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, buf_size, caps);
+		ok = ok && ctx->draw_buf[i];
+	}
+	// The shadow is the source of every transfer, so it must be DMA-capable
+	ctx->shadow = heap_caps_calloc(1, frame_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+	if (ok && config->queue_depth) {
+		ctx->spans = xQueueCreate(config->queue_depth, sizeof(display_span_t));
+		ok = ctx->spans != NULL;
+	}
+	lv_display_t *disp = ok && ctx->shadow ? lv_display_create(hres, vres) : NULL;
+	if (!disp) {
+		ESP_LOGE(TAG, "Failed to allocate display buffers");
+		display_free(ctx);
+		return NULL;
+	}
+	if (ctx->spans && xTaskCreate(display_flush_task, "menu_flush", config->task_stack, ctx,
+								  config->task_priority, &ctx->task) != pdPASS) {
+		ESP_LOGE(TAG, "Failed to start flush task");
+		lv_display_delete(disp);
+		display_free(ctx);
+		return NULL;
+	}
+	if (!s_io_lock) {
+		s_io_lock = xSemaphoreCreateMutexStatic(&s_io_lock_buf);
+	}
+	s_ctx = ctx;
+	ctx->mem.draw_buf_bytes = buf_size;
+	ctx->mem.draw_bufs = bufs;
+	ctx->mem.buf_lines = lines;
+	ctx->mem.shadow_bytes = frame_size;
+	ctx->mem.total_bytes = buf_size * bufs + frame_size;
+
+	// Register first: on SPI the blank frame completes after draw_bitmap returns
+	const esp_lcd_panel_io_callbacks_t cbs = {
+		.on_color_trans_done = display_trans_done,
+	};
+	esp_lcd_panel_io_register_event_callbacks(ctx->io, &cbs, disp);
+
+	// GDDRAM content is undefined after reset; start from a blank panel that matches the shadow
+	for (uint16_t page = 0; page < vres / DISPLAY_PAGE_ROWS; page++) {
+		display_draw_span(ctx, page, 0, hres - 1);
+	}
+	ctx->stats.bytes_sent += frame_size;
+	display_wait_idle(ctx);
+
+	lv_display_set_driver_data(disp, ctx);
+	lv_display_set_color_format(disp, LV_COLOR_FORMAT_I1);
+	lv_display_set_buffers(disp, ctx->draw_buf[0], ctx->draw_buf[1], buf_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+	lv_display_set_flush_cb(disp, display_flush_cb);
+	lv_display_add_event_cb(disp, display_rounder_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+	lv_display_add_event_cb(disp, display_render_start_cb, LV_EVENT_RENDER_START, ctx);
+	lv_display_add_event_cb(disp, display_delete_cb, LV_EVENT_DELETE, ctx);
+
+	ESP_LOGI(TAG, "Page-diff display %ux%u: %d x %u B draw buffer (%u lines) + %u B shadow = %u B",
+			 hres, vres, bufs, (unsigned)buf_size, lines, (unsigned)frame_size,
+			 (unsigned)ctx->mem.total_bytes);
+	return disp;
+}
+
+esp_err_t esp_menu_display_get_mem(esp_menu_display_mem_t *out) {
+	if (!out) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (!s_ctx) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	*out = s_ctx->mem;
+	return ESP_OK;
+}
+
+esp_err_t esp_menu_display_get_stats(esp_menu_display_stats_t *out) {
+	if (!out) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (!s_ctx) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	// The flush task adds to the bus counters; the lock keeps the 64-bit totals whole
+	taskENTER_CRITICAL(&s_ctx->stats_mux);
+	*out = s_ctx->stats;
+	taskEXIT_CRITICAL(&s_ctx->stats_mux);
+	return ESP_OK;
+}
+
+void esp_menu_display_reset_stats(void) {
+	if (s_ctx) {
+		taskENTER_CRITICAL(&s_ctx->stats_mux);
+		memset(&s_ctx->stats, 0, sizeof(s_ctx->stats));
+		taskEXIT_CRITICAL(&s_ctx->stats_mux);
+	}
+}
@@ -0,0 +1,693 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_engine.c
+ * @brief Runtime engine that turns the generated const menu tree into LVGL screens.
+ */
+
+#include "esp_menu_engine.h"
+#include "esp_menu_direct.h"
+#include "esp_menu_latency.h"
+#include "esp_menu_param.h"
+#include "esp_menu_trace.h"
+#include "esp_menu_vlist.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/** @brief Logging tag for the menu engine. */
+#define TAG "Esp_menu_engine"
+
+/** @brief Event user_data of the Back row; never a valid item index. */
+#define ENGINE_BACK_ID UINTPTR_MAX
+/** @brief s_edit_item value when no parameter row is being edited. */
+#define ENGINE_NO_EDIT UINT16_MAX
+/** @brief Text buffer for a parameter row: label plus formatted value. */
+#define ENGINE_ROW_TEXT_MAX 32
+
+/** @brief Tree currently driven by the engine. */
+static const esp_menu_tree_t *s_tree = NULL;
+/** @brief One LVGL screen per tree screen, indexed like the screen table. */
+static lv_obj_t **s_screens = NULL;
+/** @brief Index of the screen currently shown. */
+static uint16_t s_active = 0;
+/** @brief First parameter rows of the active screen, published for knob callbacks. */
+static uint16_t s_screen_params[ESP_MENU_DIRECT_MAX] = {[0 ... ESP_MENU_DIRECT_MAX - 1] = ESP_MENU_NO_PARAM};
+/** @brief Number of frames on the tree's navigation stack. */
+static uint8_t s_depth = 0;
+/** @brief Item whose parameter the encoder is editing, ENGINE_NO_EDIT if none. */
+static uint16_t s_edit_item = ENGINE_NO_EDIT;
+/** @brief Detent timing of the navigation encoder while editing. */
+static esp_menu_accel_state_t s_edit_accel;
+/** @brief Heap and residency counters reported by esp_menu_engine_get_mem_stats(). */
+static esp_menu_engine_mem_stats_t s_mem_stats;
+
+#ifdef CONFIG_ESPMENU_LAZY_SCREENS
+/** @brief LRU stamp per screen; larger means more recently shown. */
+static uint32_t *s_last_used = NULL;
+/** @brief Monotonic counter used to stamp s_last_used. */
+static uint32_t s_lru_clock = 0;
+#endif
+
+/**
+ * @brief Sample the LVGL heap and keep the high-water mark.
+ */
+static void engine_sample_heap(void) {
+	lv_mem_monitor_t mon;
+	lv_mem_monitor(&mon);
+	s_mem_stats.lvgl_heap_total = mon.total_size;
+	s_mem_stats.lvgl_heap_used = mon.total_size - mon.free_size;
+	if (mon.max_used > s_mem_stats.lvgl_heap_peak) {
+		s_mem_stats.lvgl_heap_peak = mon.max_used;
+	}
+}
+
+static lv_style_t s_style_focus;
+static lv_style_t s_style_normal;
+static bool s_styles_inited = false;
+
+/**
+ * @brief Styles for better focus visibility and spacing on monochrome OLED.
+ */
+static void engine_init_styles(void) {
+	if (s_styles_inited) {
+		return;
+	}
+	lv_style_init(&s_style_focus);
+	lv_style_set_bg_opa(&s_style_focus, LV_OPA_COVER);
+	lv_style_set_bg_color(&s_style_focus, lv_color_white());
+	lv_style_set_text_color(&s_style_focus, lv_color_black());
+	lv_style_set_border_width(&s_style_focus, 2);
+	lv_style_set_border_color(&s_style_focus, lv_color_black());
+	lv_style_set_outline_width(&s_style_focus, 1);
+	lv_style_set_outline_color(&s_style_focus, lv_color_black());
+	lv_style_set_pad_top(&s_style_focus, 2);
+	lv_style_set_pad_bottom(&s_style_focus, 2);
+	lv_style_set_pad_left(&s_style_focus, 4);
+	lv_style_set_pad_right(&s_style_focus, 4);
+
+	lv_style_init(&s_style_normal);
+	lv_style_set_pad_top(&s_style_normal, 1);
+	lv_style_set_pad_bottom(&s_style_normal, 1);
+	lv_style_set_pad_left(&s_style_normal, 4);
+	lv_style_set_pad_right(&s_style_normal, 4);
+	// Enforce a minimum item height for consistent spacing
+	lv_style_set_min_height(&s_style_normal, 14);
+	s_styles_inited = true;
+}
+
+static void engine_enter(uint16_t child);
+static bool engine_uses_vlist(uint16_t screen);
+
+/**
+ * @brief Format a parameter row as "Label: value", bracketing the value while it is edited.
+ */
+static void engine_param_text(uint16_t id, char *buf, size_t len) {
+	const esp_menu_item_desc_t *item = &s_tree->items[id];
+	char value[ENGINE_ROW_TEXT_MAX];
+	if (esp_menu_param_format(item->param, value, sizeof(value)) < 0) {
+		value[0] = '\0';
+	}
+	snprintf(buf, len, id == s_edit_item ? "%s: [%s]" : "%s: %s", item->label, value);
+}
+
+/**
+ * @brief Redraw a parameter row of the active screen; only its label is touched.
+ */
+static void engine_param_refresh(uint16_t id) {
+	const esp_menu_screen_desc_t *desc = &s_tree->screens[s_active];
+	lv_obj_t *list = lv_obj_get_child(s_screens[s_active], -1);
+	if (!list || id < desc->first_item || id >= desc->first_item + desc->item_count) {
+		return;
+	}
+	uint32_t index = id - desc->first_item;
+	if (engine_uses_vlist(s_active)) {
+		esp_menu_vlist_refresh_item(list, index);
+		return;
+	}
+	lv_obj_t *btn = lv_obj_get_child(list, (int32_t)index);
+	lv_obj_t *label = btn ? lv_obj_get_child(btn, -1) : NULL;
+	if (label) {
+		char text[ENGINE_ROW_TEXT_MAX];
+		engine_param_text(id, text, sizeof(text));
+		lv_label_set_text(label, text);
+	}
+}
+
+/**
+ * @brief Redraw every parameter row of the active screen.
+ *
+ * Values can change while a screen is not shown (direct knobs, loads from
+ * NVS), so rows are brought up to date whenever a screen is presented.
+ */
+static void engine_refresh_active(void) {
+	const esp_menu_screen_desc_t *desc = &s_tree->screens[s_active];
+	lv_obj_t *list = lv_obj_get_child(s_screens[s_active], -1);
+	if (list && engine_uses_vlist(s_active)) {
+		esp_menu_vlist_refresh(list);
+		return;
+	}
+	for (uint16_t i = 0; i < desc->item_count; i++) {
+		uint16_t id = desc->first_item + i;
+		if (s_tree->items[id].type == ESP_MENU_ITEM_PARAM) {
+			engine_param_refresh(id);
+		}
+	}
+}
+
+/**
+ * @brief Start or stop editing the parameter of item @p id.
+ *
+ * Ordinary screens put the group in edit mode so rotation arrives as key
+ * events on the row; virtualized screens are always in edit mode and divert
+ * keys through engine_vlist_key() instead.
+ */
+static void engine_param_toggle(uint16_t id) {
+	s_edit_item = s_edit_item == id ? ENGINE_NO_EDIT : id;
+	memset(&s_edit_accel, 0, sizeof(s_edit_accel));
+	if (!engine_uses_vlist(s_active)) {
+		lv_group_t *group = lv_group_get_default();
+		if (group) {
+			lv_group_set_editing(group, s_edit_item != ENGINE_NO_EDIT);
+		}
+	}
+	engine_param_refresh(id);
+}
+
+/**
+ * @brief Apply an encoder key to the parameter being edited.
+ * @return bool true if a parameter is being edited and the key was consumed.
+ */
+static bool engine_param_key(uint32_t key) {
+	if (s_edit_item == ENGINE_NO_EDIT) {
+		return false;
+	}
+	int32_t steps = 0;
+	if (key == LV_KEY_RIGHT || key == LV_KEY_UP) {
+		steps = 1;
+	} else if (key == LV_KEY_LEFT || key == LV_KEY_DOWN) {
+		steps = -1;
+	}
+	if (steps == 0) {
+		return true;
+	}
+	uint16_t param = s_tree->items[s_edit_item].param;
+	steps = esp_menu_param_accel(param, &s_edit_accel, steps);
+	if (esp_menu_param_step(param, steps)) {
+		engine_param_refresh(s_edit_item);
+	}
+	return true;
+}
+
+/**
+ * @brief Run the behaviour of an item (or the Back row) by ID.
+ */
+static void engine_dispatch(uintptr_t id) {
+	if (id == ENGINE_BACK_ID) {
+		esp_menu_engine_back();
+		return;
+	}
+	if (id >= s_tree->item_count) {
+		return;
+	}
+	const esp_menu_item_desc_t *item = &s_tree->items[id];
+	switch (item->type) {
+	case ESP_MENU_ITEM_ACTION:
+		if (item->action) {
+			ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_ACTION, id);
+			item->action();
+			ESP_MENU_TRACE_END(ESP_MENU_TRACE_ACTION, id);
+		}
+		break;
+	case ESP_MENU_ITEM_SUBMENU:
+		engine_enter(item->child_screen);
+		break;
+	case ESP_MENU_ITEM_PARAM:
+		engine_param_toggle((uint16_t)id);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Click and key handler shared by every menu item; user_data carries the item index.
+ */
+static void engine_event_handler(lv_event_t *e) {
+	if (!s_tree) {
+		return;
+	}
+	uintptr_t id = (uintptr_t)lv_event_get_user_data(e);
+	int64_t begin;
+	switch (lv_event_get_code(e)) {
+	case LV_EVENT_CLICKED:
+		begin = esp_menu_latency_action_begin();
+		ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_DISPATCH, id);
+		engine_dispatch(id);
+		ESP_MENU_TRACE_END(ESP_MENU_TRACE_DISPATCH, id);
+		esp_menu_latency_action_end(begin);
+		break;
+	case LV_EVENT_KEY:
+		if (id == s_edit_item) {
+			begin = esp_menu_latency_action_begin();
+			ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_DISPATCH, id);
+			engine_param_key(lv_event_get_key(e));
+			ESP_MENU_TRACE_END(ESP_MENU_TRACE_DISPATCH, id);
+			esp_menu_latency_action_end(begin);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Whether a screen is long enough to be shown with the virtualized list.
+ */
+static bool engine_uses_vlist(uint16_t screen) {
+#if CONFIG_ESPMENU_VLIST_THRESHOLD > 0
+	return s_tree->screens[screen].item_count > CONFIG_ESPMENU_VLIST_THRESHOLD;
+#else
+	(void)screen;
+	return false;
+#endif
+}
+
+/**
+ * @brief Map a virtualized row to its item ID; rows past the items are the Back row.
+ */
+static uintptr_t engine_vlist_item_id(uint16_t screen, uint32_t index) {
+	const esp_menu_screen_desc_t *desc = &s_tree->screens[screen];
+	return index < desc->item_count ? desc->first_item + index : ENGINE_BACK_ID;
+}
+
+/**
+ * @brief Row content for virtualized screens, straight from the const item table.
+ */
+static void engine_vlist_fill(uint32_t index, esp_menu_vlist_row_t *row, void *user_ctx) {
+	uintptr_t id = engine_vlist_item_id((uint16_t)(uintptr_t)user_ctx, index);
+	if (id == ENGINE_BACK_ID) {
+#ifdef CONFIG_ESPMENU_BACK_ITEM
+		row->text = CONFIG_ESPMENU_BACK_LABEL;
+		row->icon = LV_SYMBOL_LEFT;
+#endif
+		return;
+	}
+	row->icon = s_tree->items[id].icon;
+	if (s_tree->items[id].type == ESP_MENU_ITEM_PARAM) {
+		engine_param_text((uint16_t)id, row->buf, row->buf_size);
+		row->text = row->buf;
+	} else {
+		row->text = s_tree->items[id].label;
+	}
+}
+
+/**
+ * @brief Click handler for virtualized screens.
+ */
+static void engine_vlist_click(uint32_t index, void *user_ctx) {
+	uintptr_t id = engine_vlist_item_id((uint16_t)(uintptr_t)user_ctx, index);
+	int64_t begin = esp_menu_latency_action_begin();
+	ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_DISPATCH, id);
+	engine_dispatch(id);
+	ESP_MENU_TRACE_END(ESP_MENU_TRACE_DISPATCH, id);
+	esp_menu_latency_action_end(begin);
+}
+
+/**
+ * @brief Key hook for virtualized screens: keys edit the parameter instead of scrolling.
+ */
+static bool engine_vlist_key(uint32_t index, uint32_t key, void *user_ctx) {
+	(void)index;
+	(void)user_ctx;
+	if (s_edit_item == ENGINE_NO_EDIT) {
+		return false;  // Let the list scroll
+	}
+	int64_t begin = esp_menu_latency_action_begin();
+	ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_DISPATCH, s_edit_item);
+	engine_param_key(key);
+	ESP_MENU_TRACE_END(ESP_MENU_TRACE_DISPATCH, s_edit_item);
+	esp_menu_latency_action_end(begin);
+	return true;
+}
+
+/**
+ * @brief Create the LVGL objects for one screen of the tree.
+ * @param index Screen index.
+ * @return lv_obj_t* The new screen, or NULL on allocation failure.
+ */
+static lv_obj_t *engine_build_screen(uint16_t index) {
+	const esp_menu_screen_desc_t *desc = &s_tree->screens[index];
+	lv_obj_t *scr = lv_obj_create(NULL);
+	if (!scr) {
+		return NULL;
+	}
+	if (s_tree->screen_init) {
+		s_tree->screen_init(scr);
+	}
+
+	if (engine_uses_vlist(index)) {
+		esp_menu_vlist_config_t cfg = {
+			.item_count = desc->item_count,
+			.fill_cb = engine_vlist_fill,
+			.click_cb = engine_vlist_click,
+			.key_cb = engine_vlist_key,
+			.user_ctx = (void *)(uintptr_t)index,
+		};
+#ifdef CONFIG_ESPMENU_BACK_ITEM
+		if (index != 0) {
+			cfg.item_count++;
+		}
+#endif
+		if (!esp_menu_vlist_create(scr, &cfg)) {
+			lv_obj_delete(scr);
+			return NULL;
+		}
+		s_mem_stats.screens_built++;
+		s_mem_stats.resident_screens++;
+		engine_sample_heap();
+		return scr;
+	}
+
+	lv_obj_t *list = lv_list_create(scr);
+	lv_obj_center(list);
+	lv_obj_add_style(list, &s_style_focus, LV_PART_ITEMS | LV_STATE_FOCUSED);
+	lv_obj_add_style(list, &s_style_normal, LV_PART_ITEMS);
+
+	for (uint16_t i = 0; i < desc->item_count; i++) {
+		uint16_t id = desc->first_item + i;
+		const esp_menu_item_desc_t *item = &s_tree->items[id];
+		if (item->type == ESP_MENU_ITEM_PARAM) {
+			char text[ENGINE_ROW_TEXT_MAX];
+			engine_param_text(id, text, sizeof(text));
+			lv_obj_t *btn = lv_list_add_button(list, item->icon, text);
+			lv_obj_add_event_cb(btn, engine_event_handler, LV_EVENT_KEY,
+								(void *)(uintptr_t)id);
+			lv_obj_add_event_cb(btn, engine_event_handler, LV_EVENT_CLICKED,
+								(void *)(uintptr_t)id);
+			continue;
+		}
+		lv_obj_t *btn = lv_list_add_button(list, item->icon, item->label);
+		lv_obj_add_event_cb(btn, engine_event_handler, LV_EVENT_CLICKED,
+							(void *)(uintptr_t)id);
+	}
+#ifdef CONFIG_ESPMENU_BACK_ITEM
+	if (index != 0) {
+		lv_obj_t *back = lv_list_add_button(list, LV_SYMBOL_LEFT, CONFIG_ESPMENU_BACK_LABEL);
+		lv_obj_add_event_cb(back, engine_event_handler, LV_EVENT_CLICKED,
+							(void *)ENGINE_BACK_ID);
+	}
+#endif
+	s_mem_stats.screens_built++;
+	s_mem_stats.resident_screens++;
+	engine_sample_heap();
+	return scr;
+}
+
+#ifdef CONFIG_ESPMENU_LAZY_SCREENS
+/**
+ * @brief Check whether a screen is on the navigation stack.
+ */
+static bool engine_is_pinned(uint16_t screen) {
+	for (uint8_t i = 0; i < s_depth; i++) {
+		if (s_tree->nav_stack[i].screen == screen) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Delete least recently used submenu screens until the resident set fits.
+ *
+ * The root, the active screen and screens on the navigation stack are never
+ * evicted, so back navigation always finds its parent intact. Deletion is deferred with
+ * lv_obj_delete_async() because the click that triggered navigation may still
+ * be dispatching on the screen being left.
+ */
+static void engine_evict(void) {
+	while (s_mem_stats.resident_screens > CONFIG_ESPMENU_RESIDENT_SCREENS + 1) {
+		uint16_t victim = ESP_MENU_NO_SCREEN;
+		for (uint16_t i = 1; i < s_tree->screen_count; i++) {
+			if (i == s_active || !s_screens[i] || engine_is_pinned(i)) {
+				continue;
+			}
+			if (victim == ESP_MENU_NO_SCREEN || s_last_used[i] < s_last_used[victim]) {
+				victim = i;
+			}
+		}
+		if (victim == ESP_MENU_NO_SCREEN) {
+			return;
+		}
+		ESP_LOGD(TAG, "Evicting screen %s", s_tree->screens[victim].name);
+		lv_obj_delete_async(s_screens[victim]);
+		s_screens[victim] = NULL;
+		s_mem_stats.resident_screens--;
+		s_mem_stats.screens_evicted++;
+	}
+}
+#endif
+
+/**
+ * @brief Show a screen, attach its rows to the encoder group and restore focus.
+ * @param screen Screen index, already validated.
+ * @param focus_index Child index of the row to focus.
+ * @param scroll_y Vertical scroll offset to restore.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the screen could not be built.
+ */
+static esp_err_t engine_present(uint16_t screen, uint32_t focus_index, int32_t scroll_y) {
+	if (!s_screens[screen]) {
+		s_screens[screen] = engine_build_screen(screen);
+		if (!s_screens[screen]) {
+			ESP_LOGE(TAG, "Failed to build screen %s", s_tree->screens[screen].name);
+			return ESP_ERR_NO_MEM;
+		}
+	}
+	lv_obj_t *scr = s_screens[screen];
+	if (s_edit_item != ENGINE_NO_EDIT) {
+		// Leaving a screen ends any edit so the row is not left bracketed
+		uint16_t edited = s_edit_item;
+		s_edit_item = ENGINE_NO_EDIT;
+		engine_param_refresh(edited);
+	}
+	s_active = screen;
+	engine_publish_params(screen);
+	engine_refresh_active();
+#ifdef CONFIG_ESPMENU_LAZY_SCREENS
+	s_last_used[screen] = ++s_lru_clock;
+	engine_evict();
+#endif
+
+	// Only the visible screen's items take part in encoder navigation
+	lv_group_t *group = lv_group_get_default();
+	lv_obj_t *list = lv_obj_get_child(scr, -1);
+	if (group && list && engine_uses_vlist(screen)) {
+		// The virtualized list is the single focusable object; edit mode
+		// routes encoder rotation to it as key events
+		lv_group_remove_all_objs(group);
+		lv_group_add_obj(group, list);
+		lv_group_focus_obj(list);
+		lv_group_set_editing(group, true);
+		esp_menu_vlist_set_selected(list, focus_index);
+	} else if (group && list) {
+		lv_group_set_editing(group, false);
+		lv_group_remove_all_objs(group);
+		uint32_t n = lv_obj_get_child_count(list);
+		for (uint32_t i = 0; i < n; i++) {
+			lv_obj_t *child = lv_obj_get_child(list, (int32_t)i);
+			if (lv_obj_has_flag(child, LV_OBJ_FLAG_CLICKABLE)) {
+				lv_group_add_obj(group, child);
+			}
+		}
+		if (n > 0) {
+			lv_group_focus_obj(lv_obj_get_child(list, focus_index < n ? focus_index : 0));
+		}
+		lv_obj_scroll_to_y(list, scroll_y, LV_ANIM_OFF);
+	}
+	lv_screen_load(scr);
+	return ESP_OK;
+}
+
+/**
+ * @brief Publish the first parameter rows of @p screen for esp_menu_engine_screen_param().
+ */
+static void engine_publish_params(uint16_t screen) {
+	const esp_menu_screen_desc_t *desc = &s_tree->screens[screen];
+	uint8_t n = 0;
+	for (uint16_t i = 0; i < desc->item_count && n < ESP_MENU_DIRECT_MAX; i++) {
+		const esp_menu_item_desc_t *item = &s_tree->items[desc->first_item + i];
+		if (item->type == ESP_MENU_ITEM_PARAM) {
+			__atomic_store_n(&s_screen_params[n++], item->param, __ATOMIC_RELEASE);
+		}
+	}
+	while (n < ESP_MENU_DIRECT_MAX) {
+		__atomic_store_n(&s_screen_params[n++], ESP_MENU_NO_PARAM, __ATOMIC_RELEASE);
+	}
+}
+
+/**
+ * @brief Push the current screen's focus and scroll state, then show @p child.
+ */
+static void engine_enter(uint16_t child) {
+	if (child >= s_tree->screen_count) {
+		return;
+	}
+	bool pushed = false;
+	if (s_depth < s_tree->max_depth) {
+		esp_menu_nav_frame_t *frame = &s_tree->nav_stack[s_depth++];
+		pushed = true;
+		frame->screen = s_active;
+		frame->focus_index = 0;
+		frame->scroll_y = 0;
+		lv_obj_t *list = lv_obj_get_child(s_screens[s_active], -1);
+		lv_obj_t *focused = lv_group_get_focused(lv_group_get_default());
+		if (list && engine_uses_vlist(s_active)) {
+			frame->focus_index = esp_menu_vlist_get_selected(list);
+		} else if (list && focused && lv_obj_get_parent(focused) == list) {
+			frame->focus_index = (uint32_t)lv_obj_get_index(focused);
+			frame->scroll_y = lv_obj_get_scroll_y(list);
+		}
+	} else {
+		ESP_LOGW(TAG, "Navigation stack full (depth %u)", (unsigned)s_tree->max_depth);
+	}
+	esp_err_t err = engine_present(child, 0, 0);
+	if (err != ESP_OK) {
+		// Still on the parent screen; drop its frame so Back does not return to it twice
+		if (pushed) {
+			s_depth--;
+		}
+		ESP_LOGW(TAG, "Staying on %s: %s", s_tree->screens[s_active].name, esp_err_to_name(err));
+	}
+}
+
+esp_err_t esp_menu_engine_show(uint16_t screen) {
+	if (!s_tree || !s_screens) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	if (screen >= s_tree->screen_count) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	s_depth = 0;
+	return engine_present(screen, 0, 0);
+}
+
+esp_err_t esp_menu_engine_back(void) {
+	if (!s_tree || !s_screens) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	if (s_depth == 0) {
+		if (s_active == 0) {
+			return ESP_ERR_INVALID_STATE;
+		}
+		return engine_present(0, 0, 0);
+	}
+	const esp_menu_nav_frame_t *frame = &s_tree->nav_stack[--s_depth];
+	return engine_present(frame->screen, frame->focus_index, frame->scroll_y);
+}
+
+esp_err_t esp_menu_engine_start(const esp_menu_tree_t *tree) {
+	if (!tree || !tree->screens || tree->screen_count == 0 || !tree->nav_stack) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	s_screens = heap_caps_calloc(tree->screen_count, sizeof(lv_obj_t *),
+								 MALLOC_CAP_DEFAULT);
+	if (!s_screens) {
+		return ESP_ERR_NO_MEM;
+	}
+#ifdef CONFIG_ESPMENU_LAZY_SCREENS
+	s_last_used = heap_caps_calloc(tree->screen_count, sizeof(uint32_t),
+								   MALLOC_CAP_DEFAULT);
+	if (!s_last_used) {
+		esp_menu_engine_stop();
+		return ESP_ERR_NO_MEM;
+	}
+	// Only the root is built up front; submenus are built when entered
+	const uint16_t eager_count = 1;
+#else
+	const uint16_t eager_count = tree->screen_count;
+#endif
+	if (tree->params && esp_menu_param_register(tree->params) != ESP_OK) {
+		esp_menu_engine_stop();
+		return ESP_ERR_INVALID_ARG;
+	}
+	for (uint8_t i = 0; i < tree->direct_count && i < ESP_MENU_DIRECT_MAX; i++) {
+		esp_menu_direct_bind(i, tree->direct_params[i]);
+	}
+	s_tree = tree;
+	engine_init_styles();
+	memset(&s_mem_stats, 0, sizeof(s_mem_stats));
+
+	for (uint16_t i = 0; i < eager_count; i++) {
+		s_screens[i] = engine_build_screen(i);
+		if (!s_screens[i]) {
+			ESP_LOGE(TAG, "Failed to build screen %s", tree->screens[i].name);
+			for (uint16_t j = 0; j < i; j++) {
+				lv_obj_delete(s_screens[j]);
+			}
+			esp_menu_engine_stop();
+			return ESP_ERR_NO_MEM;
+		}
+	}
+	ESP_LOGI(TAG, "Menu tree: %u screens (%u built), %u items, LVGL heap %u/%u bytes",
+			 (unsigned)tree->screen_count, (unsigned)eager_count,
+			 (unsigned)tree->item_count, (unsigned)s_mem_stats.lvgl_heap_used,
+			 (unsigned)s_mem_stats.lvgl_heap_total);
+	return esp_menu_engine_show(0);
+}
+
+uint16_t esp_menu_engine_screen_param(uint8_t n) {
+	// Knob callbacks run without the LVGL lock, so s_active and s_tree are not read here
+	if (n >= ESP_MENU_DIRECT_MAX) {
+		return ESP_MENU_NO_PARAM;
+	}
+	return __atomic_load_n(&s_screen_params[n], __ATOMIC_ACQUIRE);
+}
+
+void esp_menu_engine_refresh_param(uint16_t param) {
+	if (!s_tree || !s_screens) {
+		return;
+	}
+	const esp_menu_screen_desc_t *desc = &s_tree->screens[s_active];
+	for (uint16_t i = 0; i < desc->item_count; i++) {
+		uint16_t id = desc->first_item + i;
+		if (s_tree->items[id].type == ESP_MENU_ITEM_PARAM && s_tree->items[id].param == param) {
+			engine_param_refresh(id);
+		}
+	}
+}
+
+void esp_menu_engine_refresh(void) {
+	if (s_tree && s_screens) {
+		engine_refresh_active();
+	}
+}
+
+esp_err_t esp_menu_engine_get_mem_stats(esp_menu_engine_mem_stats_t *out) {
+	if (!out) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (s_tree) {
+		engine_sample_heap();
+	}
+	*out = s_mem_stats;
+	return ESP_OK;
+}
+
+void esp_menu_engine_stop(void) {
+#ifdef CONFIG_ESPMENU_LAZY_SCREENS
+	heap_caps_free(s_last_used);
+	s_last_used = NULL;
+	s_lru_clock = 0;
+#endif
+	heap_caps_free(s_screens);
+	s_screens = NULL;
+	for (uint8_t i = 0; i < ESP_MENU_DIRECT_MAX; i++) {
+		__atomic_store_n(&s_screen_params[i], ESP_MENU_NO_PARAM, __ATOMIC_RELEASE);
+	}
+	s_tree = NULL;
+	s_active = 0;
+	s_depth = 0;
+	s_edit_item = ENGINE_NO_EDIT;
+}
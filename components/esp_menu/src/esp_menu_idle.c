@@ -0,0 +1,204 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_idle.c
+ * @brief Idle detection and LVGL suspend/resume.
+ */
+
+#include "esp_menu_idle.h"
+#include "esp_menu.h"
+#include "esp_menu_trace.h"
+#include "esp_log.h"
+#include "esp_lvgl_port.h"
+#include "sdkconfig.h"
+#ifdef CONFIG_ESPMENU_POWER_SAVE
+#include "esp_pm.h"
+#endif
+
+/** @brief Logging tag for idle handling. */
+#define TAG "Esp_menu_idle"
+
+#ifdef CONFIG_ESPMENU_LVGL_IDLE
+
+/** @brief Inactivity before suspending; outlasts the direct-control overlay so it gets hidden. */
+#if defined(CONFIG_ESPMENU_DIRECT_OVERLAY_MS) && \
+	CONFIG_ESPMENU_DIRECT_OVERLAY_MS + 100 > CONFIG_ESPMENU_LVGL_IDLE_TIMEOUT_MS
+#define IDLE_TIMEOUT_MS (CONFIG_ESPMENU_DIRECT_OVERLAY_MS + 100)
+#else
+#define IDLE_TIMEOUT_MS CONFIG_ESPMENU_LVGL_IDLE_TIMEOUT_MS
+#endif
+
+/** @brief How often idleness is checked while LVGL runs. */
+#define IDLE_CHECK_MS LV_MIN(IDLE_TIMEOUT_MS / 4, 250)
+
+static lv_display_t *s_disp = NULL;
+static lv_timer_t *s_check = NULL;
+#ifdef CONFIG_ESPMENU_POWER_SAVE
+/** @brief Held while LVGL runs: full CPU clock for rendering, no light sleep. */
+static esp_pm_lock_handle_t s_pm_cpu = NULL;
+static esp_pm_lock_handle_t s_pm_awake = NULL;
+#endif
+/** @brief Set while LVGL is stopped; read outside the LVGL lock. */
+static bool s_idle = false;
+/** @brief Bumped by every esp_menu_notify_update(). */
+static uint32_t s_updates = 0;
+/** @brief s_updates as last seen by the idle check. */
+static uint32_t s_updates_seen = 0;
+
+static void idle_pm_hold(bool hold) {
+#ifdef CONFIG_ESPMENU_POWER_SAVE
+	if (!s_pm_cpu || !s_pm_awake) {
+		return;
+	}
+	if (hold) {
+		esp_pm_lock_acquire(s_pm_awake);
+		esp_pm_lock_acquire(s_pm_cpu);
+	} else {
+		esp_pm_lock_release(s_pm_cpu);
+		esp_pm_lock_release(s_pm_awake);
+	}
+#else
+	(void)hold;
+#endif
+}
+
+/**
+ * @brief Resume LVGL. Must be called with the LVGL port lock held.
+ */
+static void idle_exit(void) {
+	if (!__atomic_exchange_n(&s_idle, false, __ATOMIC_SEQ_CST)) {
+		return;
+	}
+	idle_pm_hold(true);
+	ESP_MENU_TRACE_INSTANT(ESP_MENU_TRACE_IDLE, 0);
+	lvgl_port_resume();
+	// Restart the timeout so the update gets its frame and animations
+	lv_display_trigger_activity(s_disp);
+	ESP_LOGD(TAG, "LVGL resumed");
+}
+
+/**
+ * @brief Stop LVGL; runs in the idle check timer.
+ */
+static void idle_enter(void) {
+	// Render whatever is still invalidated before the refresh timer stops
+	lv_refr_now(s_disp);
+	__atomic_store_n(&s_idle, true, __ATOMIC_SEQ_CST);
+	lvgl_port_stop();
+	// Frames already queued finish on the bus; its driver holds its own lock
+	idle_pm_hold(false);
+	// An update posted while entering saw s_idle clear and only woke the task
+	if (__atomic_load_n(&s_updates, __ATOMIC_SEQ_CST) != s_updates_seen) {
+		idle_exit();
+		return;
+	}
+	ESP_MENU_TRACE_INSTANT(ESP_MENU_TRACE_IDLE, 1);
+	ESP_LOGD(TAG, "LVGL suspended");
+}
+
+static void idle_check_cb(lv_timer_t *timer) {
+	(void)timer;
+	uint32_t updates = __atomic_load_n(&s_updates, __ATOMIC_SEQ_CST);
+	if (updates != s_updates_seen) {
+		s_updates_seen = updates;
+		lv_display_trigger_activity(s_disp);
+		return;
+	}
+	if (lv_display_get_inactive_time(s_disp) < IDLE_TIMEOUT_MS ||
+			lv_anim_count_running() > 0) {
+		return;
+	}
+	idle_enter();
+}
+
+/**
+ * @brief Objects invalidated from any task resume LVGL; the lock is already held.
+ */
+static void idle_invalidate_cb(lv_event_t *e) {
+	(void)e;
+	if (__atomic_load_n(&s_idle, __ATOMIC_SEQ_CST)) {
+		idle_exit();
+		lvgl_port_task_wake(LVGL_PORT_EVENT_USER, NULL);
+	}
+}
+
+esp_err_t esp_menu_idle_start(lv_display_t *disp) {
+#ifdef CONFIG_ESPMENU_POWER_SAVE
+	esp_err_t err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "esp_menu", &s_pm_cpu);
+	if (err == ESP_OK) {
+		err = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "esp_menu_awake", &s_pm_awake);
+	}
+	if (err != ESP_OK) {
+		ESP_LOGE(TAG, "Failed to create PM locks: %s", esp_err_to_name(err));
+		esp_menu_idle_stop();
+		return err;
+	}
+	idle_pm_hold(true);
+#endif
+	s_disp = disp;
+	s_check = lv_timer_create(idle_check_cb, IDLE_CHECK_MS, NULL);
+	if (!s_check) {
+		esp_menu_idle_stop();
+		return ESP_ERR_NO_MEM;
+	}
+	lv_display_add_event_cb(disp, idle_invalidate_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+	ESP_LOGI(TAG, "LVGL suspends after %d ms idle", IDLE_TIMEOUT_MS);
+	return ESP_OK;
+}
+
+void esp_menu_idle_stop(void) {
+	idle_exit();
+	if (s_check) {
+		lv_timer_delete(s_check);
+		s_check = NULL;
+	}
+	if (s_disp) {
+		lv_display_remove_event_cb_with_user_data(s_disp, idle_invalidate_cb, NULL);
+		s_disp = NULL;
+	}
+#ifdef CONFIG_ESPMENU_POWER_SAVE
+	if (s_pm_cpu && s_pm_awake) {
+		idle_pm_hold(false);
+	}
+	if (s_pm_cpu) {
+		esp_pm_lock_delete(s_pm_cpu);
+		s_pm_cpu = NULL;
+	}
+	if (s_pm_awake) {
+		esp_pm_lock_delete(s_pm_awake);
+		s_pm_awake = NULL;
+	}
+#endif
+}
+
+bool esp_menu_idle_active(void) {
+	return __atomic_load_n(&s_idle, __ATOMIC_SEQ_CST);
+}
+
+void esp_menu_notify_update(void) {
+	__atomic_add_fetch(&s_updates, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&s_idle, __ATOMIC_SEQ_CST) && lvgl_port_lock(0)) {
+		idle_exit();
+		lvgl_port_unlock();
+	}
+	lvgl_port_task_wake(LVGL_PORT_EVENT_USER, NULL);
+}
+
+#else
+
+esp_err_t esp_menu_idle_start(lv_display_t *disp) {
+	(void)disp;
+	return ESP_OK;
+}
+
+void esp_menu_idle_stop(void) {
+}
+
+bool esp_menu_idle_active(void) {
+	return false;
+}
+
+void esp_menu_notify_update(void) {
+	lvgl_port_task_wake(LVGL_PORT_EVENT_USER, NULL);
+}
+
+#endif  // CONFIG_ESPMENU_LVGL_IDLE
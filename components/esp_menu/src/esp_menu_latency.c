@@ -0,0 +1,229 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_latency.c
+ * @brief Input-to-photon latency stamps and histograms.
+ */
+
+#include "esp_menu_latency.h"
+#include "esp_console.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *const s_stage_names[ESP_MENU_LATENCY_STAGES] = {
+	[ESP_MENU_LATENCY_INPUT] = "input",
+	[ESP_MENU_LATENCY_ACTION] = "action",
+	[ESP_MENU_LATENCY_RENDER] = "render",
+	[ESP_MENU_LATENCY_BUS] = "bus",
+	[ESP_MENU_LATENCY_TOTAL] = "total",
+};
+
+const char *esp_menu_latency_stage_name(esp_menu_latency_stage_t stage) {
+	return stage < ESP_MENU_LATENCY_STAGES ? s_stage_names[stage] : "?";
+}
+
+uint32_t esp_menu_latency_percentile(const esp_menu_latency_hist_t *hist, uint8_t percent) {
+	if (!hist || !hist->count) {
+		return 0;
+	}
+	uint32_t target = (uint32_t)(((uint64_t)hist->count * percent + 99) / 100);
+	if (target == 0) {
+		target = 1;
+	}
+	uint32_t seen = 0;
+	for (int i = 0; i < ESP_MENU_LATENCY_BUCKETS - 1; i++) {
+		seen += hist->buckets[i];
+		if (seen >= target) {
+			uint32_t upper = (2u << i) - 1;
+			return upper < hist->max_us ? upper : hist->max_us;
+		}
+	}
+	return hist->max_us;
+}
+
+#ifdef CONFIG_ESPMENU_LATENCY_STATS
+
+/** @brief Guards the stamps and histograms; taken by the input callbacks, LVGL and flush tasks. */
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+/** @brief Input stamped but not yet read by LVGL, 0 if none. */
+static int64_t s_input_us = 0;
+/** @brief Input read by LVGL and waiting for a refresh, 0 if none. */
+static int64_t s_pending_us = 0;
+static esp_menu_latency_hist_t s_hist[ESP_MENU_LATENCY_STAGES];
+
+static void latency_add(esp_menu_latency_stage_t stage, uint32_t us) {
+	esp_menu_latency_hist_t *hist = &s_hist[stage];
+	int bucket = us < 2 ? 0 : 31 - __builtin_clz(us);
+	if (bucket >= ESP_MENU_LATENCY_BUCKETS) {
+		bucket = ESP_MENU_LATENCY_BUCKETS - 1;
+	}
+	if (!hist->count || us < hist->min_us) {
+		hist->min_us = us;
+	}
+	if (us > hist->max_us) {
+		hist->max_us = us;
+	}
+	hist->last_us = us;
+	hist->sum_us += us;
+	hist->count++;
+	hist->buckets[bucket]++;
+}
+
+void esp_menu_latency_input(void) {
+	int64_t now = esp_timer_get_time();
+	portENTER_CRITICAL(&s_lock);
+	if (!s_input_us) {
+		s_input_us = now;
+	}
+	portEXIT_CRITICAL(&s_lock);
+}
+
+void esp_menu_latency_read(void) {
+	int64_t now = esp_timer_get_time();
+	portENTER_CRITICAL(&s_lock);
+	if (s_input_us) {
+		latency_add(ESP_MENU_LATENCY_INPUT, (uint32_t)(now - s_input_us));
+		if (!s_pending_us) {
+			s_pending_us = s_input_us;
+		}
+		s_input_us = 0;
+	}
+	portEXIT_CRITICAL(&s_lock);
+}
+
+int64_t esp_menu_latency_action_begin(void) {
+	portENTER_CRITICAL(&s_lock);
+	bool pending = s_pending_us != 0;
+	portEXIT_CRITICAL(&s_lock);
+	return pending ? esp_timer_get_time() : 0;
+}
+
+void esp_menu_latency_action_end(int64_t begin) {
+	if (!begin) {
+		return;
+	}
+	int64_t now = esp_timer_get_time();
+	portENTER_CRITICAL(&s_lock);
+	latency_add(ESP_MENU_LATENCY_ACTION, (uint32_t)(now - begin));
+	portEXIT_CRITICAL(&s_lock);
+}
+
+int64_t esp_menu_latency_claim(void) {
+	int64_t now = esp_timer_get_time();
+	portENTER_CRITICAL(&s_lock);
+	int64_t input_us = s_pending_us;
+	s_pending_us = 0;
+	portEXIT_CRITICAL(&s_lock);
+	// Input that changed nothing on screen would otherwise be charged to an unrelated refresh
+	if (input_us && now - input_us > ESP_MENU_LATENCY_STALE_MS * 1000LL) {
+		return 0;
+	}
+	return input_us;
+}
+
+void esp_menu_latency_frame(int64_t input_us, uint32_t render_us, uint32_t bus_us) {
+	int64_t now = esp_timer_get_time();
+	portENTER_CRITICAL(&s_lock);
+	latency_add(ESP_MENU_LATENCY_RENDER, render_us);
+	latency_add(ESP_MENU_LATENCY_BUS, bus_us);
+	if (input_us) {
+		latency_add(ESP_MENU_LATENCY_TOTAL, (uint32_t)(now - input_us));
+	}
+	portEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t esp_menu_latency_get(esp_menu_latency_stage_t stage, esp_menu_latency_hist_t *out) {
+	if (stage >= ESP_MENU_LATENCY_STAGES || !out) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	portENTER_CRITICAL(&s_lock);
+	*out = s_hist[stage];
+	portEXIT_CRITICAL(&s_lock);
+	return ESP_OK;
+}
+
+void esp_menu_latency_reset(void) {
+	portENTER_CRITICAL(&s_lock);
+	memset(s_hist, 0, sizeof(s_hist));
+	portEXIT_CRITICAL(&s_lock);
+}
+
+static int latency_cmd(int argc, char **argv) {
+	if (argc > 1) {
+		if (strcmp(argv[1], "reset") != 0) {
+			printf("usage: %s [reset]\n", argv[0]);
+			return 1;
+		}
+		esp_menu_latency_reset();
+		return 0;
+	}
+	printf("%-7s %8s %8s %8s %8s %8s %8s %8s\n", "stage", "count", "min", "mean", "p50", "p90",
+		   "p99", "max");
+	for (int stage = 0; stage < ESP_MENU_LATENCY_STAGES; stage++) {
+		esp_menu_latency_hist_t hist;
+		esp_menu_latency_get(stage, &hist);
+		printf("%-7s %8lu %8lu %8lu %8lu %8lu %8lu %8lu\n", s_stage_names[stage],
+			   (unsigned long)hist.count, (unsigned long)hist.min_us,
+			   (unsigned long)(hist.count ? hist.sum_us / hist.count : 0),
+			   (unsigned long)esp_menu_latency_percentile(&hist, 50),
+			   (unsigned long)esp_menu_latency_percentile(&hist, 90),
+			   (unsigned long)esp_menu_latency_percentile(&hist, 99),
+			   (unsigned long)hist.max_us);
+	}
+	printf("All times in us; percentiles are power-of-two bucket bounds.\n");
+	return 0;
+}
+
+esp_err_t esp_menu_latency_register_console(void) {
+	const esp_console_cmd_t cmd = {
+		.command = "menu_latency",
+		.help = "Show esp_menu input-to-photon latency per stage; 'reset' clears it",
+		.hint = "[reset]",
+		.func = latency_cmd,
+	};
+	return esp_console_cmd_register(&cmd);
+}
+
+#else
+
+void esp_menu_latency_input(void) {
+}
+
+void esp_menu_latency_read(void) {
+}
+
+int64_t esp_menu_latency_action_begin(void) {
+	return 0;
+}
+
+void esp_menu_latency_action_end(int64_t begin) {
+	(void)begin;
+}
+
+int64_t esp_menu_latency_claim(void) {
+	return 0;
+}
+
+void esp_menu_latency_frame(int64_t input_us, uint32_t render_us, uint32_t bus_us) {
+	(void)input_us;
+	(void)render_us;
+	(void)bus_us;
+}
+
+esp_err_t esp_menu_latency_get(esp_menu_latency_stage_t stage, esp_menu_latency_hist_t *out) {
+	(void)stage;
+	(void)out;
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+void esp_menu_latency_reset(void) {
+}
+
+esp_err_t esp_menu_latency_register_console(void) {
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif  // CONFIG_ESPMENU_LATENCY_STATS
@@ -0,0 +1,245 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_param.c
+ * @brief Generic clamp/wrap editing of the generated parameter table.
+ */
+
+#include "esp_menu_param.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#include <stdio.h>
+
+/** @brief Logging tag for parameter handling. */
+#define TAG "Esp_menu_param"
+
+#ifdef CONFIG_ESPMENU_ENCODER_ACCEL
+#if CONFIG_ESPMENU_ACCEL_FAST_MS >= CONFIG_ESPMENU_ACCEL_SLOW_MS
+#error "CONFIG_ESPMENU_ACCEL_FAST_MS must be smaller than CONFIG_ESPMENU_ACCEL_SLOW_MS"
+#endif
+/** @brief Detent interval at and above which no acceleration applies. */
+#define ACCEL_SLOW_US ((uint32_t)CONFIG_ESPMENU_ACCEL_SLOW_MS * 1000u)
+/** @brief Detent interval at and below which the full multiplier applies. */
+#define ACCEL_FAST_US ((uint32_t)CONFIG_ESPMENU_ACCEL_FAST_MS * 1000u)
+/** @brief Gap after which the next detent starts again at single steps. */
+#define ACCEL_IDLE_US (4 * ACCEL_SLOW_US)
+/** @brief Fixed-point one for the acceleration fraction. */
+#define ACCEL_ONE 1024u
+#endif
+
+/** @brief Parameter table registered by the generated menu. */
+static const esp_menu_param_table_t *s_params = NULL;
+/** @brief Serialises value updates from the LVGL task and the direct-control knobs. */
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+/** @brief Change observer installed by esp_menu_param_set_observer(). */
+static esp_menu_param_observer_t s_observer = NULL;
+
+/**
+ * @brief Bring @p value into the parameter's range, clamping or wrapping.
+ */
+static int32_t param_fit(const esp_menu_param_desc_t *desc, int64_t value) {
+	if (value >= desc->min && value <= desc->max) {
+		return (int32_t)value;
+	}
+	if (desc->flags & ESP_MENU_PARAM_FLAG_WRAP) {
+		int64_t span = (int64_t)desc->max - desc->min + 1;
+		int64_t off = (value - desc->min) % span;
+		if (off < 0) {
+			off += span;
+		}
+		return (int32_t)(desc->min + off);
+	}
+	return value < desc->min ? desc->min : desc->max;
+}
+
+/**
+ * @brief Run the change callback; called outside the lock.
+ */
+static void param_notify(uint16_t id, int32_t value) {
+	const esp_menu_param_desc_t *desc = &s_params->descs[id];
+	if (desc->on_change) {
+		desc->on_change(value);
+	}
+	esp_menu_param_observer_t observer = s_observer;
+	if (observer) {
+		observer(id, value);
+	}
+}
+
+/**
+ * @brief Store a new value and notify the owner if it changed.
+ */
+static bool param_store(uint16_t id, int32_t value) {
+	portENTER_CRITICAL(&s_lock);
+	bool changed = s_params->values[id] != value;
+	s_params->values[id] = value;
+	portEXIT_CRITICAL(&s_lock);
+	if (changed) {
+		param_notify(id, value);
+	}
+	return changed;
+}
+
+esp_err_t esp_menu_param_register(const esp_menu_param_table_t *table) {
+	if (!table || (table->count && (!table->descs || !table->values))) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	s_params = table;
+	for (uint16_t i = 0; i < table->count; i++) {
+		table->values[i] = table->descs[i].def;
+	}
+	ESP_LOGD(TAG, "Registered %u parameters", (unsigned)table->count);
+	return ESP_OK;
+}
+
+uint16_t esp_menu_param_count(void) {
+	return s_params ? s_params->count : 0;
+}
+
+const esp_menu_param_desc_t *esp_menu_param_get_desc(uint16_t id) {
+	if (!s_params || id >= s_params->count) {
+		return NULL;
+	}
+	return &s_params->descs[id];
+}
+
+int32_t esp_menu_param_get(uint16_t id) {
+	if (!s_params || id >= s_params->count) {
+		return 0;
+	}
+	return s_params->values[id];
+}
+
+esp_err_t esp_menu_param_set(uint16_t id, int32_t value) {
+	if (!s_params || id >= s_params->count) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	const esp_menu_param_desc_t *desc = &s_params->descs[id];
+	// Explicit sets clamp even for wrapping parameters
+	if (value < desc->min) {
+		value = desc->min;
+	} else if (value > desc->max) {
+		value = desc->max;
+	}
+	param_store(id, value);
+	return ESP_OK;
+}
+
+bool esp_menu_param_step(uint16_t id, int32_t steps) {
+	if (!s_params || id >= s_params->count || steps == 0) {
+		return false;
+	}
+	const esp_menu_param_desc_t *desc = &s_params->descs[id];
+	portENTER_CRITICAL(&s_lock);
+	int32_t old = s_params->values[id];
+	int32_t next = param_fit(desc, (int64_t)old + (int64_t)steps * desc->step);
+	s_params->values[id] = next;
+	portEXIT_CRITICAL(&s_lock);
+	if (next == old) {
+		return false;
+	}
+	param_notify(id, next);
+	return true;
+}
+
+#ifdef CONFIG_ESPMENU_ENCODER_ACCEL
+/**
+ * @brief Multiplier at full speed; derived so a flick of
+ *        CONFIG_ESPMENU_ACCEL_FLICK_DETENTS detents sweeps the whole range.
+ */
+static uint32_t param_accel_max(const esp_menu_param_desc_t *desc) {
+	if (desc->accel_max) {
+		return desc->accel_max;
+	}
+	uint64_t detents = ((int64_t)desc->max - desc->min) / desc->step;
+	uint64_t mult = detents / CONFIG_ESPMENU_ACCEL_FLICK_DETENTS;
+	if (mult < 1) {
+		return 1;
+	}
+	return mult > UINT16_MAX ? UINT16_MAX : (uint32_t)mult;
+}
+#endif
+
+int32_t esp_menu_param_accel(uint16_t id, esp_menu_accel_state_t *state, int32_t detents) {
+#ifdef CONFIG_ESPMENU_ENCODER_ACCEL
+	if (!s_params || id >= s_params->count || !state || detents == 0) {
+		return detents;
+	}
+	int64_t now = esp_timer_get_time();
+	int8_t dir = detents > 0 ? 1 : -1;
+	uint32_t count = detents > 0 ? (uint32_t)detents : (uint32_t)-detents;
+	int64_t gap = now - state->last_us;
+	if (dir != state->dir || gap > ACCEL_IDLE_US) {
+		state->interval_us = ACCEL_SLOW_US;
+	} else {
+		// Several detents in one event arrived within the same gap
+		uint32_t interval = (uint32_t)gap / count;
+		state->interval_us = (state->interval_us * 3 + interval) / 4;
+	}
+	state->last_us = now;
+	state->dir = dir;
+
+	const esp_menu_param_desc_t *desc = &s_params->descs[id];
+	if (desc->accel == ESP_MENU_ACCEL_NONE || state->interval_us >= ACCEL_SLOW_US) {
+		return detents;
+	}
+	uint32_t t = ACCEL_ONE;
+	if (state->interval_us > ACCEL_FAST_US) {
+		t = (ACCEL_SLOW_US - state->interval_us) * ACCEL_ONE / (ACCEL_SLOW_US - ACCEL_FAST_US);
+	}
+	if (desc->accel == ESP_MENU_ACCEL_QUADRATIC) {
+		t = t * t / ACCEL_ONE;
+	}
+	int32_t mult = 1 + (int32_t)((param_accel_max(desc) - 1) * t / ACCEL_ONE);
+	return detents * mult;
+#else
+	(void)id;
+	(void)state;
+	return detents;
+#endif
+}
+
+int esp_menu_param_format(uint16_t id, char *buf, size_t len) {
+	if (!s_params || id >= s_params->count || !buf) {
+		return -1;
+	}
+	const esp_menu_param_desc_t *desc = &s_params->descs[id];
+	int32_t value = s_params->values[id];
+	switch (desc->type) {
+	case ESP_MENU_PARAM_BOOL:
+		return snprintf(buf, len, "%s", value ? "On" : "Off");
+	case ESP_MENU_PARAM_ENUM:
+		if (desc->options && value >= desc->min && value <= desc->max) {
+			return snprintf(buf, len, "%s", desc->options[value]);
+		}
+		break;
+	default:
+		break;
+	}
+	return snprintf(buf, len, desc->format ? desc->format : "%d", (int)value);
+}
+
+void esp_menu_param_reset_defaults(void) {
+	if (!s_params) {
+		return;
+	}
+	for (uint16_t i = 0; i < s_params->count; i++) {
+		param_store(i, s_params->descs[i].def);
+	}
+}
+
+uint32_t esp_menu_param_key_hash(uint16_t id) {
+	if (!s_params || id >= s_params->count || !s_params->descs[id].nvs_key) {
+		return 0;
+	}
+	uint32_t hash = 2166136261u;
+	for (const char *key = s_params->descs[id].nvs_key; *key; key++) {
+		hash = (hash ^ (uint8_t)*key) * 16777619u;
+	}
+	return hash ? hash : 1;
+}
+
+void esp_menu_param_set_observer(esp_menu_param_observer_t observer) {
+	s_observer = observer;
+}
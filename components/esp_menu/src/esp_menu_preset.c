@@ -0,0 +1,523 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_preset.c
+ * @brief Preset bank: paged NVS index, on-demand bodies and a virtualized browser.
+ */
+
+#include "esp_menu_preset.h"
+#include "sdkconfig.h"
+#include <string.h>
+
+#ifdef CONFIG_ESPMENU_PRESETS
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_menu_engine.h"
+#include "esp_menu_param.h"
+#include "esp_menu_store.h"
+#include "esp_menu_trace.h"
+#include "esp_menu_vlist.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lvgl.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+/** @brief Logging tag for the preset bank. */
+#define TAG "Esp_menu_preset"
+
+/** @brief s_cache_page value when no page is cached. */
+#define PRESET_NO_PAGE UINT16_MAX
+
+#ifdef CONFIG_ESPMENU_BACK_LABEL
+#define PRESET_BACK_LABEL CONFIG_ESPMENU_BACK_LABEL
+#else
+#define PRESET_BACK_LABEL "Back"
+#endif
+
+/** @brief On-flash index entry. */
+typedef struct __attribute__((packed)) {
+	char name[ESP_MENU_PRESET_NAME_MAX];
+	uint16_t count;     ///< Values in the body, 0 for an empty slot
+	uint16_t reserved;
+	uint32_t crc;       ///< CRC-32 of the body
+} preset_entry_t;
+
+/**
+ * @brief One value of a preset body.
+ *
+ * Values are matched to parameters by key on load, so a preset survives
+ * parameters being added, removed or reordered in menu.json.
+ */
+typedef struct __attribute__((packed)) {
+	uint32_t key_hash;  ///< esp_menu_param_key_hash() of the parameter
+	int32_t value;
+} preset_value_t;
+
+/** @brief On-flash index page. */
+typedef struct {
+	preset_entry_t entries[ESP_MENU_PRESET_PAGE_SIZE];
+} preset_page_t;
+
+/** @brief Write queued to the persistence worker. */
+typedef struct {
+	uint16_t index;
+	preset_entry_t entry;     ///< New index entry; count 0 erases the slot
+	preset_value_t values[];  ///< Body, entry.count values
+} preset_job_t;
+
+/** @brief Handle on the preset namespace. */
+static nvs_handle_t s_nvs = 0;
+/** @brief Guards the page cache between the UI and the worker. */
+static SemaphoreHandle_t s_cache_lock = NULL;
+/** @brief The one cached index page. */
+static preset_page_t s_cache;
+/** @brief Page held in s_cache, PRESET_NO_PAGE if none. */
+static uint16_t s_cache_page = PRESET_NO_PAGE;
+
+/** @brief Browser screen, NULL while closed. */
+static lv_obj_t *s_browser = NULL;
+/** @brief Screen shown before the browser opened. */
+static lv_obj_t *s_prev_screen = NULL;
+/** @brief Encoder group before the browser took the encoder. */
+static lv_group_t *s_prev_group = NULL;
+/** @brief Browser's own group, so the menu's focus is left untouched. */
+static lv_group_t *s_group = NULL;
+/** @brief Click behaviour of the open browser. */
+static esp_menu_preset_browse_mode_t s_mode;
+
+static void preset_page_key(uint16_t page, char *key, size_t len) {
+	snprintf(key, len, "idx_%u", (unsigned)page);
+}
+
+static void preset_body_key(uint16_t index, char *key, size_t len) {
+	snprintf(key, len, "pre_%u", (unsigned)index);
+}
+
+/**
+ * @brief Read an index page; a missing or foreign page reads as all empty.
+ */
+static esp_err_t preset_read_page(uint16_t page, preset_page_t *out) {
+	char key[16];
+	preset_page_key(page, key, sizeof(key));
+	size_t len = sizeof(*out);
+	esp_err_t err = nvs_get_blob(s_nvs, key, out, &len);
+	if (err == ESP_OK && len == sizeof(*out)) {
+		return ESP_OK;
+	}
+	memset(out, 0, sizeof(*out));
+	if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND || err == ESP_ERR_NVS_INVALID_LENGTH) {
+		if (err != ESP_ERR_NVS_NOT_FOUND) {
+			ESP_LOGW(TAG, "Index page %u has the wrong size, treating it as empty", (unsigned)page);
+		}
+		return ESP_OK;
+	}
+	return err;
+}
+
+/**
+ * @brief Replace the cached copy of an entry if its page is cached.
+ */
+static void preset_cache_put(uint16_t index, const preset_entry_t *entry) {
+	xSemaphoreTake(s_cache_lock, portMAX_DELAY);
+	if (s_cache_page == index / ESP_MENU_PRESET_PAGE_SIZE) {
+		s_cache.entries[index % ESP_MENU_PRESET_PAGE_SIZE] = *entry;
+	}
+	xSemaphoreGive(s_cache_lock);
+}
+
+/**
+ * @brief Worker job: write or erase a body, then patch its index page. One commit.
+ *
+ * The body is written first; after a power cut in between, the index CRC no
+ * longer matches the body and the preset refuses to load instead of loading
+ * garbage.
+ */
+static esp_err_t preset_write_job(void *arg) {
+	preset_job_t *job = arg;
+	uint16_t page_no = job->index / ESP_MENU_PRESET_PAGE_SIZE;
+	char key[16];
+	preset_page_t *page = heap_caps_malloc(sizeof(*page), MALLOC_CAP_DEFAULT);
+	esp_err_t err = page ? ESP_OK : ESP_ERR_NO_MEM;
+
+	if (err == ESP_OK) {
+		preset_body_key(job->index, key, sizeof(key));
+		if (job->entry.count) {
+			err = nvs_set_blob(s_nvs, key, job->values, job->entry.count * sizeof(preset_value_t));
+		} else {
+			err = nvs_erase_key(s_nvs, key);
+			err = err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+		}
+	}
+	if (err == ESP_OK) {
+		err = preset_read_page(page_no, page);
+	}
+	if (err == ESP_OK) {
+		page->entries[job->index % ESP_MENU_PRESET_PAGE_SIZE] = job->entry;
+		bool empty = true;
+		for (uint8_t i = 0; i < ESP_MENU_PRESET_PAGE_SIZE && empty; i++) {
+			empty = page->entries[i].count == 0;
+		}
+		preset_page_key(page_no, key, sizeof(key));
+		if (empty) {
+			err = nvs_erase_key(s_nvs, key);
+			err = err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+		} else {
+			err = nvs_set_blob(s_nvs, key, page, sizeof(*page));
+		}
+	}
+	if (err == ESP_OK) {
+		// Body and index page
+		ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_NVS_COMMIT, 2);
+		err = nvs_commit(s_nvs);
+		ESP_MENU_TRACE_END(ESP_MENU_TRACE_NVS_COMMIT, 2);
+	}
+	if (err == ESP_OK) {
+		preset_cache_put(job->index, &job->entry);
+	} else {
+		ESP_LOGW(TAG, "Writing preset %u failed: %s", (unsigned)job->index, esp_err_to_name(err));
+		// The UI may show the queued state; reread the page from flash
+		xSemaphoreTake(s_cache_lock, portMAX_DELAY);
+		if (s_cache_page == page_no) {
+			s_cache_page = PRESET_NO_PAGE;
+		}
+		xSemaphoreGive(s_cache_lock);
+	}
+	heap_caps_free(page);
+	heap_caps_free(job);
+	return err;
+}
+
+/**
+ * @brief Queue a job for the persistence worker; frees it if it cannot be queued.
+ */
+static esp_err_t preset_post(preset_job_t *job) {
+	esp_err_t err = esp_menu_store_post(preset_write_job, job);
+	if (err != ESP_OK) {
+		heap_caps_free(job);
+		return err;
+	}
+	return ESP_OK;
+}
+
+esp_err_t esp_menu_preset_init(void) {
+	if (s_cache_lock) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	if (strcmp(CONFIG_ESPMENU_PRESET_PARTITION, NVS_DEFAULT_PART_NAME) != 0) {
+		esp_err_t err = nvs_flash_init_partition(CONFIG_ESPMENU_PRESET_PARTITION);
+		if (err != ESP_OK) {
+			ESP_LOGE(TAG, "Preset partition %s: %s", CONFIG_ESPMENU_PRESET_PARTITION,
+					 esp_err_to_name(err));
+			return err;
+		}
+	}
+	esp_err_t err = nvs_open_from_partition(CONFIG_ESPMENU_PRESET_PARTITION,
+											CONFIG_ESPMENU_PRESET_NAMESPACE, NVS_READWRITE, &s_nvs);
+	if (err != ESP_OK) {
+		ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(err));
+		s_nvs = 0;
+		return err;
+	}
+	s_cache_lock = xSemaphoreCreateMutex();
+	if (!s_cache_lock) {
+		nvs_close(s_nvs);
+		s_nvs = 0;
+		return ESP_ERR_NO_MEM;
+	}
+	s_cache_page = PRESET_NO_PAGE;
+	return ESP_OK;
+}
+
+void esp_menu_preset_deinit(void) {
+	if (!s_cache_lock) {
+		return;
+	}
+	vSemaphoreDelete(s_cache_lock);
+	s_cache_lock = NULL;
+	nvs_close(s_nvs);
+	s_nvs = 0;
+	s_cache_page = PRESET_NO_PAGE;
+}
+
+uint16_t esp_menu_preset_capacity(void) {
+	return CONFIG_ESPMENU_PRESET_COUNT;
+}
+
+esp_err_t esp_menu_preset_get_info(uint16_t index, esp_menu_preset_info_t *out) {
+	if (index >= CONFIG_ESPMENU_PRESET_COUNT || !out) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (!s_cache_lock) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	uint16_t page_no = index / ESP_MENU_PRESET_PAGE_SIZE;
+	esp_err_t err = ESP_OK;
+	xSemaphoreTake(s_cache_lock, portMAX_DELAY);
+	if (s_cache_page != page_no) {
+		err = preset_read_page(page_no, &s_cache);
+		s_cache_page = err == ESP_OK ? page_no : PRESET_NO_PAGE;
+	}
+	if (err == ESP_OK) {
+		const preset_entry_t *entry = &s_cache.entries[index % ESP_MENU_PRESET_PAGE_SIZE];
+		memcpy(out->name, entry->name, sizeof(out->name));
+		out->name[sizeof(out->name) - 1] = '\0';
+		out->count = entry->count;
+		out->crc = entry->crc;
+	}
+	xSemaphoreGive(s_cache_lock);
+	return err;
+}
+
+/**
+ * @brief Apply a preset body.
+ *
+ * Parameters the preset does not hold start at their default, values of
+ * keys that no longer exist are ignored, and parameters without an nvs_key
+ * are never part of a preset and keep their value.
+ */
+static void preset_apply(const preset_value_t *values, uint16_t count) {
+	uint16_t params = esp_menu_param_count();
+	for (uint16_t id = 0; id < params; id++) {
+		uint32_t hash = esp_menu_param_key_hash(id);
+		if (!hash) {
+			continue;
+		}
+		int32_t value = esp_menu_param_get_desc(id)->def;
+		for (uint16_t v = 0; v < count; v++) {
+			if (values[v].key_hash == hash) {
+				value = values[v].value;
+				break;
+			}
+		}
+		esp_menu_param_set(id, value);
+	}
+}
+
+esp_err_t esp_menu_preset_load(uint16_t index) {
+	esp_menu_preset_info_t info;
+	esp_err_t err = esp_menu_preset_get_info(index, &info);
+	if (err != ESP_OK) {
+		return err;
+	}
+	if (info.count == 0) {
+		return ESP_ERR_NOT_FOUND;
+	}
+	size_t len = info.count * sizeof(preset_value_t);
+	preset_value_t *body = heap_caps_malloc(len, MALLOC_CAP_DEFAULT);
+	if (!body) {
+		return ESP_ERR_NO_MEM;
+	}
+	char key[16];
+	preset_body_key(index, key, sizeof(key));
+	size_t got = len;
+	err = nvs_get_blob(s_nvs, key, body, &got);
+	if (err == ESP_OK && (got != len || esp_rom_crc32_le(0, (const uint8_t *)body, len) != info.crc)) {
+		err = ESP_ERR_INVALID_CRC;
+	}
+	if (err == ESP_OK) {
+		// Changed values are written behind by esp_menu_store like any edit
+		preset_apply(body, info.count);
+	} else {
+		ESP_LOGW(TAG, "Preset %u unusable: %s", (unsigned)index, esp_err_to_name(err));
+	}
+	heap_caps_free(body);
+	return err;
+}
+
+esp_err_t esp_menu_preset_save(uint16_t index, const char *name) {
+	if (index >= CONFIG_ESPMENU_PRESET_COUNT) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (!s_cache_lock) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	uint16_t params = esp_menu_param_count();
+	preset_job_t *job =
+		heap_caps_calloc(1, sizeof(*job) + params * sizeof(preset_value_t), MALLOC_CAP_DEFAULT);
+	if (!job) {
+		return ESP_ERR_NO_MEM;
+	}
+	job->index = index;
+	// Only persisted parameters have a key to be matched by
+	uint16_t count = 0;
+	for (uint16_t id = 0; id < params; id++) {
+		uint32_t hash = esp_menu_param_key_hash(id);
+		if (hash) {
+			job->values[count++] = (preset_value_t){.key_hash = hash, .value = esp_menu_param_get(id)};
+		}
+	}
+	if (count == 0) {
+		heap_caps_free(job);
+		return ESP_ERR_NOT_SUPPORTED;
+	}
+	if (name) {
+		strncpy(job->entry.name, name, sizeof(job->entry.name) - 1);
+	} else {
+		snprintf(job->entry.name, sizeof(job->entry.name), "Preset %03u", (unsigned)index + 1);
+	}
+	job->entry.count = count;
+	job->entry.crc = esp_rom_crc32_le(0, (const uint8_t *)job->values, count * sizeof(preset_value_t));
+	preset_entry_t entry = job->entry;
+	esp_err_t err = preset_post(job);
+	if (err == ESP_OK) {
+		preset_cache_put(index, &entry);
+	}
+	return err;
+}
+
+esp_err_t esp_menu_preset_delete(uint16_t index) {
+	if (index >= CONFIG_ESPMENU_PRESET_COUNT) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (!s_cache_lock) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	preset_job_t *job = heap_caps_calloc(1, sizeof(*job), MALLOC_CAP_DEFAULT);
+	if (!job) {
+		return ESP_ERR_NO_MEM;
+	}
+	job->index = index;
+	preset_entry_t entry = job->entry;
+	esp_err_t err = preset_post(job);
+	if (err == ESP_OK) {
+		preset_cache_put(index, &entry);
+	}
+	return err;
+}
+
+/**
+ * @brief Give the encoder back to the menu and delete the browser.
+ */
+static void preset_browser_close(void) {
+	for (lv_indev_t *indev = lv_indev_get_next(NULL); indev; indev = lv_indev_get_next(indev)) {
+		if (lv_indev_get_type(indev) == LV_INDEV_TYPE_ENCODER) {
+			lv_indev_set_group(indev, s_prev_group);
+		}
+	}
+	lv_group_remove_all_objs(s_group);
+	lv_screen_load(s_prev_screen);
+	// Deferred: the click that closes the browser is still dispatching on it
+	lv_obj_delete_async(s_browser);
+	s_browser = NULL;
+	esp_menu_engine_refresh();
+}
+
+/**
+ * @brief Browser rows: Back first, then "NNN name" or "NNN ---" per slot.
+ */
+static void preset_browser_fill(uint32_t index, esp_menu_vlist_row_t *row, void *user_ctx) {
+	(void)user_ctx;
+	if (index == 0) {
+		row->text = PRESET_BACK_LABEL;
+		row->icon = LV_SYMBOL_LEFT;
+		return;
+	}
+	esp_menu_preset_info_t info;
+	if (esp_menu_preset_get_info((uint16_t)(index - 1), &info) == ESP_OK && info.count) {
+		snprintf(row->buf, row->buf_size, "%03u %s", (unsigned)index, info.name);
+	} else {
+		snprintf(row->buf, row->buf_size, "%03u ---", (unsigned)index);
+	}
+	row->text = row->buf;
+}
+
+static void preset_browser_click(uint32_t index, void *user_ctx) {
+	(void)user_ctx;
+	if (index > 0) {
+		uint16_t slot = (uint16_t)(index - 1);
+		esp_err_t err = s_mode == ESP_MENU_PRESET_BROWSE_SAVE ? esp_menu_preset_save(slot, NULL)
+																: esp_menu_preset_load(slot);
+		if (err == ESP_ERR_NOT_FOUND) {
+			return;  // Empty slot: stay in the browser
+		}
+		if (err != ESP_OK) {
+			ESP_LOGW(TAG, "Preset %u: %s", (unsigned)index, esp_err_to_name(err));
+		}
+	}
+	preset_browser_close();
+}
+
+esp_err_t esp_menu_preset_browser_open(esp_menu_preset_browse_mode_t mode) {
+	if (!s_cache_lock || s_browser) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	if (!s_group) {
+		s_group = lv_group_create();
+		if (!s_group) {
+			return ESP_ERR_NO_MEM;
+		}
+	}
+	s_browser = lv_obj_create(NULL);
+	if (!s_browser) {
+		return ESP_ERR_NO_MEM;
+	}
+	esp_menu_vlist_config_t cfg = {
+		.item_count = CONFIG_ESPMENU_PRESET_COUNT + 1,
+		.fill_cb = preset_browser_fill,
+		.click_cb = preset_browser_click,
+	};
+	lv_obj_t *list = esp_menu_vlist_create(s_browser, &cfg);
+	if (!list) {
+		lv_obj_delete(s_browser);
+		s_browser = NULL;
+		return ESP_ERR_NO_MEM;
+	}
+	s_mode = mode;
+	s_prev_screen = lv_screen_active();
+	s_prev_group = lv_group_get_default();
+	lv_group_add_obj(s_group, list);
+	lv_group_focus_obj(list);
+	lv_group_set_editing(s_group, true);
+	for (lv_indev_t *indev = lv_indev_get_next(NULL); indev; indev = lv_indev_get_next(indev)) {
+		if (lv_indev_get_type(indev) == LV_INDEV_TYPE_ENCODER) {
+			s_prev_group = lv_indev_get_group(indev);
+			lv_indev_set_group(indev, s_group);
+		}
+	}
+	lv_screen_load(s_browser);
+	return ESP_OK;
+}
+
+#else  // CONFIG_ESPMENU_PRESETS
+
+esp_err_t esp_menu_preset_init(void) {
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+void esp_menu_preset_deinit(void) {}
+
+uint16_t esp_menu_preset_capacity(void) {
+	return 0;
+}
+
+esp_err_t esp_menu_preset_get_info(uint16_t index, esp_menu_preset_info_t *out) {
+	(void)index;
+	(void)out;
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_menu_preset_load(uint16_t index) {
+	(void)index;
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_menu_preset_save(uint16_t index, const char *name) {
+	(void)index;
+	(void)name;
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_menu_preset_delete(uint16_t index) {
+	(void)index;
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_menu_preset_browser_open(esp_menu_preset_browse_mode_t mode) {
+	(void)mode;
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif  // CONFIG_ESPMENU_PRESETS
@@ -0,0 +1,236 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_saver.c
+ * @brief Inactivity dimming and panel power-off.
+ */
+
+#include "esp_menu_saver.h"
+#include "esp_log.h"
+#include "esp_menu_display.h"
+#include "esp_lvgl_port.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+/** @brief Logging tag for the screen saver. */
+#define TAG "Esp_menu_saver"
+
+#ifdef CONFIG_ESPMENU_SCREEN_SAVER
+
+/** @brief Contrast command shared by SSD1306 and SH1107. */
+#define SAVER_CMD_CONTRAST 0x81
+#define SAVER_DIM_MS (CONFIG_ESPMENU_SAVER_DIM_S * 1000u)
+#define SAVER_OFF_MS (CONFIG_ESPMENU_SAVER_OFF_S * 1000u)
+/** @brief Wait for the LVGL port lock in the timer; lvgl_port_lock(0) would wait forever. */
+#define SAVER_LOCK_TRY_MS 1
+/** @brief Retry delay when the LVGL port lock is taken. */
+#define SAVER_RETRY_MS 10
+
+static lv_display_t *s_disp = NULL;
+static esp_lcd_panel_io_handle_t s_io = NULL;
+static esp_lcd_panel_handle_t s_panel = NULL;
+static esp_timer_handle_t s_timer = NULL;
+/** @brief Changed under the LVGL port lock, read without it. */
+static esp_menu_saver_state_t s_state = ESP_MENU_SAVER_ON;
+/** @brief Time of the last input in ms, wrapping. */
+static uint32_t s_last_input_ms = 0;
+/** @brief Cleared by esp_menu_saver_stop() before the timer is deleted. */
+static bool s_running = false;
+/** @brief Callers using s_timer without the LVGL port lock; the stop waits for them. */
+static uint32_t s_busy = 0;
+
+static uint32_t saver_now_ms(void) {
+	return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void saver_contrast(uint8_t contrast) {
+	esp_menu_display_io_lock();
+	esp_err_t err = esp_lcd_panel_io_tx_param(s_io, SAVER_CMD_CONTRAST, &contrast, 1);
+	esp_menu_display_io_unlock();
+	if (err != ESP_OK) {
+		ESP_LOGW(TAG, "Failed to set contrast: %s", esp_err_to_name(err));
+	}
+}
+
+/**
+ * @brief Switch the panel; the flush task may be sending a frame on the same IO.
+ */
+static void saver_power(bool on) {
+	esp_menu_display_io_lock();
+	esp_err_t err = esp_lcd_panel_disp_on_off(s_panel, on);
+	esp_menu_display_io_unlock();
+	if (err != ESP_OK) {
+		ESP_LOGW(TAG, "Failed to switch display %s: %s", on ? "on" : "off", esp_err_to_name(err));
+	}
+}
+
+/**
+ * @brief Claim s_timer outside the LVGL port lock; false once stopping.
+ */
+static bool saver_enter(void) {
+	__atomic_add_fetch(&s_busy, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&s_running, __ATOMIC_SEQ_CST)) {
+		return true;
+	}
+	__atomic_sub_fetch(&s_busy, 1, __ATOMIC_SEQ_CST);
+	return false;
+}
+
+static void saver_exit(void) {
+	__atomic_sub_fetch(&s_busy, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Arm the timer for the next stage after @p quiet_ms without input.
+ */
+static void saver_arm(uint32_t quiet_ms) {
+	uint32_t due_ms;
+	esp_menu_saver_state_t state = __atomic_load_n(&s_state, __ATOMIC_ACQUIRE);
+	if (state == ESP_MENU_SAVER_ON) {
+		due_ms = SAVER_DIM_MS;
+	} else if (state == ESP_MENU_SAVER_DIMMED && SAVER_OFF_MS > SAVER_DIM_MS) {
+		due_ms = SAVER_OFF_MS;
+	} else {
+		return;
+	}
+	uint32_t wait_ms = due_ms > quiet_ms ? due_ms - quiet_ms : 1;
+	// Fails harmlessly if input already re-armed it
+	esp_timer_start_once(s_timer, (uint64_t)wait_ms * 1000);
+}
+
+/**
+ * @brief Restore the panel. Must be called with the LVGL port lock held.
+ */
+static void saver_wake(void) {
+	esp_menu_saver_state_t state = __atomic_load_n(&s_state, __ATOMIC_ACQUIRE);
+	if (state == ESP_MENU_SAVER_OFF) {
+		saver_power(true);
+		// Objects changed while off were not invalidated; redraw everything once
+		lv_display_enable_invalidation(s_disp, true);
+		lv_obj_invalidate(lv_display_get_screen_active(s_disp));
+	}
+	if (state != ESP_MENU_SAVER_ON) {
+		saver_contrast(CONFIG_ESPMENU_DISPLAY_CONTRAST);
+		__atomic_store_n(&s_state, ESP_MENU_SAVER_ON, __ATOMIC_RELEASE);
+		ESP_LOGD(TAG, "Display on");
+	}
+}
+
+/**
+ * @brief Apply the stage due after the quiet time, or wake the panel after input.
+ *
+ * Runs in the esp_timer task, which also serves the knobs, so it never waits
+ * for the LVGL port lock: the deinit path holds it while stopping the saver.
+ */
+static void saver_timer_cb(void *arg) {
+	(void)arg;
+	if (!saver_enter()) {
+		return;
+	}
+	if (!lvgl_port_lock(SAVER_LOCK_TRY_MS)) {
+		// Fails harmlessly if input already re-armed it
+		esp_timer_start_once(s_timer, SAVER_RETRY_MS * 1000u);
+		saver_exit();
+		return;
+	}
+	if (!s_timer) {
+		lvgl_port_unlock();
+		saver_exit();
+		return;
+	}
+	uint32_t quiet_ms = saver_now_ms() - __atomic_load_n(&s_last_input_ms, __ATOMIC_ACQUIRE);
+	esp_menu_saver_state_t state = __atomic_load_n(&s_state, __ATOMIC_ACQUIRE);
+	if (quiet_ms < SAVER_DIM_MS) {
+		saver_wake();
+	} else if (state == ESP_MENU_SAVER_ON) {
+		saver_contrast(CONFIG_ESPMENU_SAVER_DIM_CONTRAST);
+		__atomic_store_n(&s_state, ESP_MENU_SAVER_DIMMED, __ATOMIC_RELEASE);
+		ESP_LOGD(TAG, "Display dimmed");
+	} else if (state == ESP_MENU_SAVER_DIMMED && SAVER_OFF_MS > SAVER_DIM_MS &&
+			   quiet_ms >= SAVER_OFF_MS) {
+		// Stop invalidation first so nothing is rendered or flushed while off
+		lv_display_enable_invalidation(s_disp, false);
+		saver_power(false);
+		__atomic_store_n(&s_state, ESP_MENU_SAVER_OFF, __ATOMIC_RELEASE);
+		ESP_LOGD(TAG, "Display off");
+	}
+	saver_arm(quiet_ms);
+	lvgl_port_unlock();
+	saver_exit();
+}
+
+esp_err_t esp_menu_saver_start(lv_display_t *disp, esp_lcd_panel_io_handle_t io,
+							   esp_lcd_panel_handle_t panel) {
+	const esp_timer_create_args_t args = {
+		.callback = saver_timer_cb,
+		.name = "menu_saver",
+	};
+	esp_err_t err = esp_timer_create(&args, &s_timer);
+	if (err != ESP_OK) {
+		return err;
+	}
+	s_disp = disp;
+	s_io = io;
+	s_panel = panel;
+	s_state = ESP_MENU_SAVER_ON;
+	s_last_input_ms = saver_now_ms();
+	__atomic_store_n(&s_running, true, __ATOMIC_SEQ_CST);
+	saver_arm(0);
+	return ESP_OK;
+}
+
+void esp_menu_saver_stop(void) {
+	if (!s_timer) {
+		return;
+	}
+	// A callback that already claimed the timer gives up on the lock we hold and leaves
+	__atomic_store_n(&s_running, false, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&s_busy, __ATOMIC_SEQ_CST) > 0) {
+		vTaskDelay(1);
+	}
+	esp_timer_stop(s_timer);
+	esp_timer_delete(s_timer);
+	s_timer = NULL;
+	saver_wake();
+	s_disp = NULL;
+	s_io = NULL;
+	s_panel = NULL;
+}
+
+void esp_menu_saver_activity(void) {
+	__atomic_store_n(&s_last_input_ms, saver_now_ms(), __ATOMIC_RELEASE);
+	if (__atomic_load_n(&s_state, __ATOMIC_ACQUIRE) == ESP_MENU_SAVER_ON || !saver_enter()) {
+		return;
+	}
+	// Callers include the knob's esp_timer callback; the saver's timer does the wake
+	esp_timer_stop(s_timer);
+	esp_timer_start_once(s_timer, 0);
+	saver_exit();
+}
+
+esp_menu_saver_state_t esp_menu_saver_get_state(void) {
+	return __atomic_load_n(&s_state, __ATOMIC_ACQUIRE);
+}
+
+#else
+
+esp_err_t esp_menu_saver_start(lv_display_t *disp, esp_lcd_panel_io_handle_t io,
+							   esp_lcd_panel_handle_t panel) {
+	(void)disp;
+	(void)io;
+	(void)panel;
+	return ESP_OK;
+}
+
+void esp_menu_saver_stop(void) {
+}
+
+void esp_menu_saver_activity(void) {
+}
+
+esp_menu_saver_state_t esp_menu_saver_get_state(void) {
+	return ESP_MENU_SAVER_ON;
+}
+
+#endif  // CONFIG_ESPMENU_SCREEN_SAVER
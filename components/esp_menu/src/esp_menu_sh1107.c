@@ -0,0 +1,230 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_sh1107.c
+ * @brief SH1107 panel driver with page addressing and partial windows.
+ */
+
+#include "esp_menu_sh1107.h"
+#include "driver/gpio.h"
+#include "esp_lcd_panel_interface.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <sys/cdefs.h>
+
+/** @brief Logging tag for the SH1107 driver. */
+#define TAG "Esp_menu_sh1107"
+
+/** @brief Columns and rows of SH1107 display RAM. */
+#define SH1107_RAM_SIZE 128
+
+#define SH1107_CMD_COLUMN_LOW 0x00
+#define SH1107_CMD_COLUMN_HIGH 0x10
+#define SH1107_CMD_PAGE_ADDRESSING 0x20
+#define SH1107_CMD_CONTRAST 0x81
+#define SH1107_CMD_SEG_REMAP 0xA0
+#define SH1107_CMD_ENTIRE_ON_RESUME 0xA4
+#define SH1107_CMD_NORMAL 0xA6
+#define SH1107_CMD_INVERT 0xA7
+#define SH1107_CMD_MULTIPLEX 0xA8
+#define SH1107_CMD_DISP_OFF 0xAE
+#define SH1107_CMD_DISP_ON 0xAF
+#define SH1107_CMD_PAGE 0xB0
+#define SH1107_CMD_COM_SCAN_INC 0xC0
+#define SH1107_CMD_COM_SCAN_DEC 0xC8
+#define SH1107_CMD_DISP_OFFSET 0xD3
+#define SH1107_CMD_CLOCK_DIV 0xD5
+#define SH1107_CMD_PRECHARGE 0xD9
+#define SH1107_CMD_VCOMH 0xDB
+#define SH1107_CMD_START_LINE 0xDC
+
+typedef struct {
+	esp_lcd_panel_t base;
+	esp_lcd_panel_io_handle_t io;
+	int reset_gpio;
+	bool reset_level;
+	uint16_t width;
+	uint16_t height;
+	int x_gap;
+	int y_gap;
+} sh1107_panel_t;
+
+static esp_err_t sh1107_cmd(sh1107_panel_t *sh, int cmd, const uint8_t *param, size_t len) {
+	return esp_lcd_panel_io_tx_param(sh->io, cmd, param, len);
+}
+
+static esp_err_t sh1107_del(esp_lcd_panel_t *panel) {
+	sh1107_panel_t *sh = __containerof(panel, sh1107_panel_t, base);
+	if (sh->reset_gpio >= 0) {
+		gpio_reset_pin(sh->reset_gpio);
+	}
+	free(sh);
+	return ESP_OK;
+}
+
+static esp_err_t sh1107_reset(esp_lcd_panel_t *panel) {
+	sh1107_panel_t *sh = __containerof(panel, sh1107_panel_t, base);
+	// The SH1107 has no software reset command
+	if (sh->reset_gpio >= 0) {
+		gpio_set_level(sh->reset_gpio, sh->reset_level);
+		vTaskDelay(pdMS_TO_TICKS(10));
+		gpio_set_level(sh->reset_gpio, !sh->reset_level);
+		vTaskDelay(pdMS_TO_TICKS(10));
+	}
+	return ESP_OK;
+}
+
+static esp_err_t sh1107_init(esp_lcd_panel_t *panel) {
+	sh1107_panel_t *sh = __containerof(panel, sh1107_panel_t, base);
+	const struct {
+		uint8_t cmd;
+		uint8_t param;
+		uint8_t len;
+	} seq[] = {
+		{SH1107_CMD_DISP_OFF, 0, 0},
+		{SH1107_CMD_START_LINE, 0x00, 1},
+		{SH1107_CMD_PAGE_ADDRESSING, 0, 0},
+		{SH1107_CMD_CONTRAST, 0x80, 1},
+		{SH1107_CMD_SEG_REMAP, 0, 0},
+		{SH1107_CMD_COM_SCAN_INC, 0, 0},
+		{SH1107_CMD_MULTIPLEX, sh->height - 1, 1},
+		{SH1107_CMD_DISP_OFFSET, 0x00, 1},
+		{SH1107_CMD_CLOCK_DIV, 0x51, 1},
+		{SH1107_CMD_PRECHARGE, 0x22, 1},
+		{SH1107_CMD_VCOMH, 0x35, 1},
+		{SH1107_CMD_ENTIRE_ON_RESUME, 0, 0},
+		{SH1107_CMD_NORMAL, 0, 0},
+	};
+	for (size_t i = 0; i < sizeof(seq) / sizeof(seq[0]); i++) {
+		esp_err_t err = sh1107_cmd(sh, seq[i].cmd, seq[i].len ? &seq[i].param : NULL, seq[i].len);
+		if (err != ESP_OK) {
+			ESP_LOGE(TAG, "Init command 0x%02X failed: %s", seq[i].cmd, esp_err_to_name(err));
+			return err;
+		}
+	}
+	return ESP_OK;
+}
+
+/**
+ * @brief Send a page-aligned window, one addressed transfer per page.
+ *
+ * @p color_data holds (x_end - x_start) bytes per page, pages in order.
+ */
+static esp_err_t sh1107_draw_bitmap(esp_lcd_panel_t *panel, int x_start, int y_start, int x_end, int y_end,
+									const void *color_data) {
+	sh1107_panel_t *sh = __containerof(panel, sh1107_panel_t, base);
+	if (x_start < 0 || x_start >= x_end || x_end > sh->width || y_start < 0 || y_start >= y_end ||
+			y_end > sh->height || (y_start | y_end) % 8) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	x_start += sh->x_gap;
+	x_end += sh->x_gap;
+	y_start += sh->y_gap;
+	y_end += sh->y_gap;
+	if (x_end > SH1107_RAM_SIZE || y_end > SH1107_RAM_SIZE) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	const uint8_t *data = color_data;
+	size_t len = x_end - x_start;
+	const uint8_t column[2] = {
+		SH1107_CMD_COLUMN_LOW | (x_start & 0x0F),
+		SH1107_CMD_COLUMN_HIGH | (x_start >> 4),
+	};
+	for (int page = y_start / 8; page < y_end / 8; page++, data += len) {
+		// Page address followed by the start column, all as one command stream
+		esp_err_t err = sh1107_cmd(sh, SH1107_CMD_PAGE | page, column, sizeof(column));
+		if (err == ESP_OK) {
+			err = esp_lcd_panel_io_tx_color(sh->io, -1, data, len);
+		}
+		if (err != ESP_OK) {
+			return err;
+		}
+	}
+	return ESP_OK;
+}
+
+static esp_err_t sh1107_invert_color(esp_lcd_panel_t *panel, bool invert) {
+	sh1107_panel_t *sh = __containerof(panel, sh1107_panel_t, base);
+	return sh1107_cmd(sh, invert ? SH1107_CMD_INVERT : SH1107_CMD_NORMAL, NULL, 0);
+}
+
+static esp_err_t sh1107_mirror(esp_lcd_panel_t *panel, bool mirror_x, bool mirror_y) {
+	sh1107_panel_t *sh = __containerof(panel, sh1107_panel_t, base);
+	esp_err_t err = sh1107_cmd(sh, SH1107_CMD_SEG_REMAP | (mirror_x ? 1 : 0), NULL, 0);
+	if (err == ESP_OK) {
+		err = sh1107_cmd(sh, mirror_y ? SH1107_CMD_COM_SCAN_DEC : SH1107_CMD_COM_SCAN_INC, NULL, 0);
+	}
+	return err;
+}
+
+static esp_err_t sh1107_swap_xy(esp_lcd_panel_t *panel, bool swap_axes) {
+	// Page bytes run along COM; swapping axes would need a software rotation
+	return swap_axes ? ESP_ERR_NOT_SUPPORTED : ESP_OK;
+}
+
+static esp_err_t sh1107_set_gap(esp_lcd_panel_t *panel, int x_gap, int y_gap) {
+	sh1107_panel_t *sh = __containerof(panel, sh1107_panel_t, base);
+	if (x_gap < 0 || y_gap < 0 || y_gap % 8) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	sh->x_gap = x_gap;
+	sh->y_gap = y_gap;
+	return ESP_OK;
+}
+
+static esp_err_t sh1107_disp_on_off(esp_lcd_panel_t *panel, bool on_off) {
+	sh1107_panel_t *sh = __containerof(panel, sh1107_panel_t, base);
+	return sh1107_cmd(sh, on_off ? SH1107_CMD_DISP_ON : SH1107_CMD_DISP_OFF, NULL, 0);
+}
+
+esp_err_t esp_menu_new_panel_sh1107(const esp_lcd_panel_io_handle_t io,
+									const esp_lcd_panel_dev_config_t *panel_dev_config,
+									esp_lcd_panel_handle_t *ret_panel) {
+	if (!io || !panel_dev_config || !ret_panel || panel_dev_config->bits_per_pixel != 1) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	const esp_menu_sh1107_config_t *geometry = panel_dev_config->vendor_config;
+	uint16_t width = geometry ? geometry->width : SH1107_RAM_SIZE;
+	uint16_t height = geometry ? geometry->height : SH1107_RAM_SIZE;
+	if (width == 0 || width > SH1107_RAM_SIZE || height == 0 || height > SH1107_RAM_SIZE || height % 8) {
+		ESP_LOGE(TAG, "Unsupported geometry %ux%u", width, height);
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	if (panel_dev_config->reset_gpio_num >= 0) {
+		gpio_config_t io_conf = {
+			.mode = GPIO_MODE_OUTPUT,
+			.pin_bit_mask = 1ULL << panel_dev_config->reset_gpio_num,
+		};
+		esp_err_t err = gpio_config(&io_conf);
+		if (err != ESP_OK) {
+			return err;
+		}
+	}
+
+	sh1107_panel_t *sh = calloc(1, sizeof(*sh));
+	if (!sh) {
+		return ESP_ERR_NO_MEM;
+	}
+	sh->io = io;
+	sh->reset_gpio = panel_dev_config->reset_gpio_num;
+	sh->reset_level = panel_dev_config->flags.reset_active_high;
+	sh->width = width;
+	sh->height = height;
+	sh->base.del = sh1107_del;
+	sh->base.reset = sh1107_reset;
+	sh->base.init = sh1107_init;
+	sh->base.draw_bitmap = sh1107_draw_bitmap;
+	sh->base.invert_color = sh1107_invert_color;
+	sh->base.set_gap = sh1107_set_gap;
+	sh->base.mirror = sh1107_mirror;
+	sh->base.swap_xy = sh1107_swap_xy;
+	sh->base.disp_on_off = sh1107_disp_on_off;
+	*ret_panel = &sh->base;
+	ESP_LOGI(TAG, "SH1107 panel %ux%u", width, height);
+	return ESP_OK;
+}
@@ -0,0 +1,90 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_stats.c
+ * @brief Aggregated frame, bus, heap and stack counters.
+ */
+
+#include "esp_menu.h"
+#include "esp_lvgl_port.h"
+#include "esp_menu_display.h"
+#include "esp_menu_latency.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lvgl.h"
+#include "sdkconfig.h"
+#include <string.h>
+
+#ifdef CONFIG_ESPMENU_STATS
+
+/** @brief Name esp_lvgl_port gives its LVGL task. */
+#define STATS_LVGL_TASK_NAME "taskLVGL"
+
+/** @brief Start of the sample window, 0 for boot. */
+static int64_t s_sample_start_us = 0;
+
+esp_err_t esp_menu_get_stats(esp_menu_stats_t *out) {
+	if (!out) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	// The port lock does not exist before lvgl_port_init()
+	if (!lv_is_initialized() || !lvgl_port_lock(0)) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	if (!lv_display_get_default()) {
+		lvgl_port_unlock();
+		return ESP_ERR_INVALID_STATE;
+	}
+	memset(out, 0, sizeof(*out));
+	out->sample_us = (uint64_t)(esp_timer_get_time() - s_sample_start_us);
+
+	esp_menu_display_stats_t disp;
+	if (esp_menu_display_get_stats(&disp) == ESP_OK) {
+		out->frames = disp.frames;
+		out->area_px = disp.area_px;
+		out->last_frame_area_px = disp.last_frame_area_px;
+		out->render_us = disp.render_us_total;
+		out->last_render_us = disp.last_render_us;
+		out->flush_us = disp.bus_us_total;
+		out->last_flush_us = disp.last_bus_us;
+		out->last_frame_us = disp.last_frame_us;
+		out->bytes_written = disp.bytes_sent;
+		out->bytes_skipped = disp.bytes_skipped;
+		out->spans = disp.spans;
+	}
+
+	lv_mem_monitor_t mon;
+	lv_mem_monitor(&mon);
+	lvgl_port_unlock();
+	out->lvgl_heap_total = mon.total_size;
+	out->lvgl_heap_used = mon.total_size - mon.free_size;
+	out->lvgl_heap_peak = mon.max_used;
+	out->lvgl_heap_frag_pct = mon.frag_pct;
+
+	TaskHandle_t lvgl_task = xTaskGetHandle(STATS_LVGL_TASK_NAME);
+	if (lvgl_task) {
+		out->lvgl_stack_free_min = uxTaskGetStackHighWaterMark(lvgl_task) * sizeof(StackType_t);
+	}
+	return ESP_OK;
+}
+
+void esp_menu_stats_reset(void) {
+	if (lv_is_initialized() && lvgl_port_lock(0)) {
+		esp_menu_display_reset_stats();
+		lvgl_port_unlock();
+	}
+	esp_menu_latency_reset();
+	s_sample_start_us = esp_timer_get_time();
+}
+
+#else
+
+esp_err_t esp_menu_get_stats(esp_menu_stats_t *out) {
+	(void)out;
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+void esp_menu_stats_reset(void) {
+}
+
+#endif  // CONFIG_ESPMENU_STATS
@@ -0,0 +1,1075 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_store.c
+ * @brief Coalescing write-behind of dirty parameters to NVS.
+ *
+ * Two backends share the dirty tracking: one NVS entry per parameter key, or
+ * (CONFIG_ESPMENU_STORE_BLOB) a single versioned record holding every
+ * parameter, protected by a CRC-32.
+ *
+ * Favorite slots live in RAM from init onwards; saving or clearing one only
+ * updates the cache and marks the slot for the worker to write.
+ */
+
+#include "esp_menu_store.h"
+#include "sdkconfig.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef CONFIG_ESPMENU_ENABLE_NVS
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_menu_param.h"
+#include "esp_menu_trace.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "nvs.h"
+
+/** @brief Logging tag for parameter persistence. */
+#define TAG "Esp_menu_store"
+
+/** @brief Worker notification: write the dirty parameters. */
+#define STORE_EVT_FLUSH (1u << 0)
+/** @brief Worker notification: write the pending favorite slots. */
+#define STORE_EVT_FAV (1u << 1)
+/** @brief Worker notification: run the queued jobs. */
+#define STORE_EVT_JOB (1u << 2)
+/** @brief Worker notification: exit. */
+#define STORE_EVT_EXIT (1u << 31)
+
+#ifdef CONFIG_ESPMENU_FAV_SLOTS
+#define STORE_FAV_SLOTS CONFIG_ESPMENU_FAV_SLOTS
+#else
+#define STORE_FAV_SLOTS 0
+#endif
+
+#ifdef CONFIG_ESPMENU_STORE_MAX_DEFER_MS
+#define STORE_MAX_DEFER_US ((int64_t)CONFIG_ESPMENU_STORE_MAX_DEFER_MS * 1000)
+#define STORE_WINDOW_POLL_MS CONFIG_ESPMENU_STORE_WINDOW_POLL_MS
+#else
+#define STORE_MAX_DEFER_US 2000000
+#define STORE_WINDOW_POLL_MS 2
+#endif
+
+/** @brief Jobs that can wait for the worker at once. */
+#define STORE_JOB_QUEUE_LEN 8
+
+/** @brief Number of 32-bit words in a parameter bitmask. */
+#define STORE_WORDS(count) (((count) + 31u) / 32u)
+
+#ifdef CONFIG_ESPMENU_STORE_BLOB
+/** @brief NVS key of the parameter record. */
+#define STORE_BLOB_KEY "params"
+/** @brief Record magic, "EMNU" in little-endian byte order. */
+#define STORE_BLOB_MAGIC 0x554E4D45u
+/** @brief Record layout version; bump when the header or entry layout changes. */
+#define STORE_BLOB_VERSION 1
+
+/** @brief Record header. The CRC covers the fields before it and all entries. */
+typedef struct __attribute__((packed)) {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t count;     ///< Number of entries that follow
+	uint32_t crc;
+} store_blob_header_t;
+#endif
+
+/** @brief Favorite body magic, "EMFV" in little-endian byte order; store_blob_entry_t follow. */
+#define STORE_FAV_MAGIC 0x56464D45u
+
+/**
+ * @brief One parameter in the record or in a favorite body.
+ *
+ * Entries are matched to parameters by a hash of their NVS key rather than by
+ * position, so adding, removing or reordering parameters in menu.json keeps
+ * every value whose key survived; new parameters start at their default.
+ */
+typedef struct __attribute__((packed)) {
+	uint32_t key_hash;  ///< esp_menu_param_key_hash() of the parameter
+	int32_t value;
+} store_blob_entry_t;
+
+/** @brief NVS handle, open for the lifetime of the store. */
+static nvs_handle_t s_nvs = 0;
+/** @brief Parameter count at init. */
+static uint16_t s_count = 0;
+/** @brief Parameters changed since they were last written. */
+static uint32_t *s_dirty = NULL;
+/** @brief Parameters written but not yet committed. */
+static uint32_t *s_inflight = NULL;
+/** @brief Values known to be in flash, to skip rewriting unchanged values. */
+static int32_t *s_persisted = NULL;
+/** @brief Values written in the pass in progress, adopted into s_persisted on commit. */
+static int32_t *s_written = NULL;
+/** @brief Serialises NVS access between the worker and esp_menu_store_sync(). */
+static SemaphoreHandle_t s_lock = NULL;
+/** @brief Write-behind worker. */
+static TaskHandle_t s_task = NULL;
+/** @brief Jobs posted with esp_menu_store_post(). */
+static QueueHandle_t s_jobs = NULL;
+/** @brief Task waiting in esp_menu_store_deinit() for the worker to exit. */
+static TaskHandle_t s_waiter = NULL;
+#ifdef CONFIG_ESPMENU_AUTO_SAVE
+/** @brief Quiet-period timer, restarted by every change. */
+static esp_timer_handle_t s_debounce = NULL;
+#endif
+static esp_menu_store_stats_t s_stats;
+/** @brief Favorite cache, STORE_FAV_SLOTS rows of s_count values. */
+static int32_t *s_favs = NULL;
+/**
+ * @brief Worker copy of the body being written, so the cache lock is not held across NVS calls.
+ *
+ * STORE_FAV_MAGIC followed by one store_blob_entry_t per parameter with an NVS key.
+ */
+static uint32_t *s_fav_buf = NULL;
+/** @brief Slots holding a favorite. */
+static uint32_t s_fav_used = 0;
+/** @brief Slots changed in the cache and not yet written. */
+static uint32_t s_fav_pending = 0;
+/** @brief Application window callback, see esp_menu_store_set_window_cb(). */
+static esp_menu_store_window_cb_t s_window_cb = NULL;
+static void *s_window_ctx = NULL;
+/** @brief Real-time task that must be blocked while flash is written. */
+static TaskHandle_t s_rt_task = NULL;
+/** @brief Guards the window callback and its context. */
+static portMUX_TYPE s_window_lock = portMUX_INITIALIZER_UNLOCKED;
+/** @brief Guards s_favs and s_fav_used; held only for memory copies. */
+static portMUX_TYPE s_fav_lock = portMUX_INITIALIZER_UNLOCKED;
+/** @brief Key hash per parameter, 0 for parameters without an NVS key. */
+static uint32_t *s_hashes = NULL;
+/** @brief Number of parameters with an NVS key, i.e. entries in the record or a favorite body. */
+static uint16_t s_keyed = 0;
+#ifdef CONFIG_ESPMENU_STORE_BLOB
+/** @brief Record in flash is missing, corrupt or outdated and must be rewritten. */
+static bool s_blob_stale = false;
+#endif
+
+#ifndef CONFIG_ESPMENU_STORE_BLOB
+/**
+ * @brief Write one parameter with the NVS setter matching its storage type.
+ */
+static esp_err_t store_set(const esp_menu_param_desc_t *desc, int32_t value) {
+	switch (desc->type) {
+	case ESP_MENU_PARAM_I8:
+		return nvs_set_i8(s_nvs, desc->nvs_key, (int8_t)value);
+	case ESP_MENU_PARAM_U16:
+		return nvs_set_u16(s_nvs, desc->nvs_key, (uint16_t)value);
+	case ESP_MENU_PARAM_I16:
+		return nvs_set_i16(s_nvs, desc->nvs_key, (int16_t)value);
+	case ESP_MENU_PARAM_I32:
+		return nvs_set_i32(s_nvs, desc->nvs_key, value);
+	default:
+		return nvs_set_u8(s_nvs, desc->nvs_key, (uint8_t)value);
+	}
+}
+#endif
+
+/**
+ * @brief Read one parameter with the NVS getter matching its storage type.
+ *
+ * Also used by the record backend to migrate values saved one key at a time.
+ */
+static esp_err_t store_get(const esp_menu_param_desc_t *desc, int32_t *value) {
+	esp_err_t err;
+	switch (desc->type) {
+	case ESP_MENU_PARAM_I8: {
+		int8_t v = 0;
+		err = nvs_get_i8(s_nvs, desc->nvs_key, &v);
+		*value = v;
+		break;
+	}
+	case ESP_MENU_PARAM_U16: {
+		uint16_t v = 0;
+		err = nvs_get_u16(s_nvs, desc->nvs_key, &v);
+		*value = v;
+		break;
+	}
+	case ESP_MENU_PARAM_I16: {
+		int16_t v = 0;
+		err = nvs_get_i16(s_nvs, desc->nvs_key, &v);
+		*value = v;
+		break;
+	}
+	case ESP_MENU_PARAM_I32:
+		err = nvs_get_i32(s_nvs, desc->nvs_key, value);
+		break;
+	default: {
+		uint8_t v = 0;
+		err = nvs_get_u8(s_nvs, desc->nvs_key, &v);
+		*value = v;
+		break;
+	}
+	}
+	return err;
+}
+
+/** @brief Queued job. */
+typedef struct {
+	esp_menu_store_job_t job;
+	void *arg;
+} store_job_t;
+
+#ifdef CONFIG_ESPMENU_STORE_BLOB
+/**
+ * @brief CRC of a record: header fields before the CRC, then the entries.
+ */
+static uint32_t store_blob_crc(const store_blob_header_t *hdr, const store_blob_entry_t *entries) {
+	uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)hdr, offsetof(store_blob_header_t, crc));
+	return esp_rom_crc32_le(crc, (const uint8_t *)entries, hdr->count * sizeof(store_blob_entry_t));
+}
+
+/**
+ * @brief Rewrite the whole record if a dirty parameter changed or the record is stale.
+ */
+static esp_err_t store_write_blob(void) {
+	bool changed = s_blob_stale;
+	for (uint16_t w = 0; w < STORE_WORDS(s_count); w++) {
+		uint32_t bits = __atomic_exchange_n(&s_dirty[w], 0, __ATOMIC_ACQ_REL);
+		s_inflight[w] = bits;
+		while (bits) {
+			uint16_t id = w * 32 + __builtin_ctz(bits);
+			bits &= bits - 1;
+			if (esp_menu_param_get(id) != s_persisted[id]) {
+				changed = true;
+			} else {
+				s_stats.writes_skipped++;
+			}
+		}
+	}
+	if (!changed) {
+		memset(s_inflight, 0, STORE_WORDS(s_count) * sizeof(uint32_t));
+		return ESP_OK;
+	}
+
+	size_t len = sizeof(store_blob_header_t) + s_keyed * sizeof(store_blob_entry_t);
+	uint8_t *buf = heap_caps_malloc(len, MALLOC_CAP_DEFAULT);
+	esp_err_t err = ESP_ERR_NO_MEM;
+	if (buf) {
+		store_blob_header_t *hdr = (store_blob_header_t *)buf;
+		store_blob_entry_t *entries = (store_blob_entry_t *)(hdr + 1);
+		uint16_t n = 0;
+		for (uint16_t id = 0; id < s_count; id++) {
+			if (s_hashes[id]) {
+				s_written[id] = esp_menu_param_get(id);
+				entries[n].key_hash = s_hashes[id];
+				entries[n].value = s_written[id];
+				n++;
+			}
+		}
+		hdr->magic = STORE_BLOB_MAGIC;
+		hdr->version = STORE_BLOB_VERSION;
+		hdr->count = n;
+		hdr->crc = store_blob_crc(hdr, entries);
+		err = nvs_set_blob(s_nvs, STORE_BLOB_KEY, buf, len);
+		if (err == ESP_OK) {
+			ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_NVS_COMMIT, n);
+			err = nvs_commit(s_nvs);
+			ESP_MENU_TRACE_END(ESP_MENU_TRACE_NVS_COMMIT, n);
+		}
+		heap_caps_free(buf);
+	}
+	if (err != ESP_OK) {
+		ESP_LOGW(TAG, "Writing parameter record failed: %s", esp_err_to_name(err));
+		for (uint16_t w = 0; w < STORE_WORDS(s_count); w++) {
+			__atomic_fetch_or(&s_dirty[w], s_inflight[w], __ATOMIC_RELEASE);
+			s_inflight[w] = 0;
+		}
+		s_stats.errors++;
+		return err;
+	}
+	for (uint16_t id = 0; id < s_count; id++) {
+		if (s_hashes[id]) {
+			s_persisted[id] = s_written[id];
+		}
+	}
+	memset(s_inflight, 0, STORE_WORDS(s_count) * sizeof(uint32_t));
+	s_blob_stale = false;
+	s_stats.commits++;
+	s_stats.keys_written++;
+	return ESP_OK;
+}
+
+/**
+ * @brief Load the record; values without a matching entry keep their current value.
+ * @return esp_err_t ESP_OK, ESP_ERR_NVS_NOT_FOUND if there is no record, or
+ *         ESP_ERR_INVALID_CRC / ESP_ERR_INVALID_VERSION / ESP_ERR_INVALID_SIZE if it is unusable.
+ */
+static esp_err_t store_load_blob(uint16_t *loaded) {
+	size_t len = 0;
+	esp_err_t err = nvs_get_blob(s_nvs, STORE_BLOB_KEY, NULL, &len);
+	if (err != ESP_OK) {
+		return err;
+	}
+	if (len < sizeof(store_blob_header_t) ||
+		(len - sizeof(store_blob_header_t)) % sizeof(store_blob_entry_t) != 0) {
+		return ESP_ERR_INVALID_SIZE;
+	}
+	uint8_t *buf = heap_caps_malloc(len, MALLOC_CAP_DEFAULT);
+	if (!buf) {
+		return ESP_ERR_NO_MEM;
+	}
+	err = nvs_get_blob(s_nvs, STORE_BLOB_KEY, buf, &len);
+	const store_blob_header_t *hdr = (const store_blob_header_t *)buf;
+	const store_blob_entry_t *entries = (const store_blob_entry_t *)(hdr + 1);
+	if (err == ESP_OK && (hdr->magic != STORE_BLOB_MAGIC || hdr->version > STORE_BLOB_VERSION)) {
+		err = ESP_ERR_INVALID_VERSION;
+	} else if (err == ESP_OK &&
+			   len != sizeof(*hdr) + (size_t)hdr->count * sizeof(store_blob_entry_t)) {
+		err = ESP_ERR_INVALID_SIZE;
+	} else if (err == ESP_OK && store_blob_crc(hdr, entries) != hdr->crc) {
+		err = ESP_ERR_INVALID_CRC;
+	}
+	if (err == ESP_OK) {
+		uint16_t matched = 0;
+		bool clamped = false;
+		for (uint16_t id = 0; id < s_count; id++) {
+			for (uint16_t e = 0; s_hashes[id] && e < hdr->count; e++) {
+				if (entries[e].key_hash == s_hashes[id]) {
+					esp_menu_param_set(id, entries[e].value);
+					s_persisted[id] = esp_menu_param_get(id);
+					clamped |= s_persisted[id] != entries[e].value;
+					matched++;
+					break;
+				}
+			}
+		}
+		// Added, removed or re-ranged parameters: rewrite so the record matches the schema
+		s_blob_stale = clamped || matched != s_keyed || hdr->count != s_keyed;
+		*loaded = matched;
+	}
+	heap_caps_free(buf);
+	return err;
+}
+#endif
+
+#ifndef CONFIG_ESPMENU_STORE_BLOB
+/**
+ * @brief Write every dirty key whose value differs from flash, then commit once.
+ */
+static esp_err_t store_write_keys(void) {
+	esp_err_t ret = ESP_OK;
+	uint32_t written = 0;
+	for (uint16_t w = 0; w < STORE_WORDS(s_count); w++) {
+		uint32_t bits = __atomic_exchange_n(&s_dirty[w], 0, __ATOMIC_ACQ_REL);
+		while (bits) {
+			uint32_t bit = bits & -bits;
+			bits &= bits - 1;
+			uint16_t id = w * 32 + __builtin_ctz(bit);
+			int32_t value = esp_menu_param_get(id);
+			if (value == s_persisted[id]) {
+				s_stats.writes_skipped++;
+				continue;
+			}
+			esp_err_t err = store_set(esp_menu_param_get_desc(id), value);
+			if (err != ESP_OK) {
+				ESP_LOGW(TAG, "Writing %s failed: %s", esp_menu_param_get_desc(id)->nvs_key,
+						 esp_err_to_name(err));
+				__atomic_fetch_or(&s_dirty[w], bit, __ATOMIC_RELEASE);
+				s_stats.errors++;
+				ret = ret == ESP_OK ? err : ret;
+				continue;
+			}
+			s_written[id] = value;
+			s_inflight[w] |= bit;
+			written++;
+		}
+	}
+	if (written) {
+		ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_NVS_COMMIT, written);
+		esp_err_t err = nvs_commit(s_nvs);
+		ESP_MENU_TRACE_END(ESP_MENU_TRACE_NVS_COMMIT, written);
+		for (uint16_t w = 0; w < STORE_WORDS(s_count); w++) {
+			uint32_t bits = s_inflight[w];
+			s_inflight[w] = 0;
+			if (err != ESP_OK) {
+				// Not durable: keep the keys dirty and retry on the next pass
+				__atomic_fetch_or(&s_dirty[w], bits, __ATOMIC_RELEASE);
+				continue;
+			}
+			while (bits) {
+				uint16_t id = w * 32 + __builtin_ctz(bits);
+				bits &= bits - 1;
+				s_persisted[id] = s_written[id];
+			}
+		}
+		if (err == ESP_OK) {
+			s_stats.commits++;
+			s_stats.keys_written += written;
+		} else {
+			ESP_LOGW(TAG, "nvs_commit failed: %s", esp_err_to_name(err));
+			s_stats.errors++;
+			ret = ret == ESP_OK ? err : ret;
+		}
+	}
+	return ret;
+}
+#endif
+
+/**
+ * @brief Whether the application currently allows flash writes; true without a gate.
+ */
+static bool store_window_open(void) {
+	portENTER_CRITICAL(&s_window_lock);
+	esp_menu_store_window_cb_t cb = s_window_cb;
+	void *ctx = s_window_ctx;
+	TaskHandle_t rt = s_rt_task;
+	portEXIT_CRITICAL(&s_window_lock);
+	if (rt) {
+		eTaskState state = eTaskGetState(rt);
+		if (state != eBlocked && state != eSuspended) {
+			return false;
+		}
+	}
+	return !cb || cb(ctx);
+}
+
+/**
+ * @brief Take the NVS lock inside a write window.
+ *
+ * Waits for the window with the lock released so esp_menu_store_sync() and
+ * the worker queue behind each other rather than behind the window. Taking
+ * the lock can block for a whole commit of the other, so the window is
+ * checked again once it is held and the wait resumes if it closed meanwhile.
+ * Past STORE_MAX_DEFER_US the batch runs anyway, so changes are never held
+ * indefinitely by a window that does not open.
+ */
+static void store_enter_window(void) {
+	int64_t start = esp_timer_get_time();
+	bool waited = false;
+	bool forced = false;
+	ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_NVS_WAIT, 0);
+	for (;;) {
+		bool open = store_window_open();
+		if (!open && esp_timer_get_time() - start >= STORE_MAX_DEFER_US) {
+			forced = true;
+		}
+		if (open || forced) {
+			xSemaphoreTake(s_lock, portMAX_DELAY);
+			if (forced || store_window_open()) {
+				break;
+			}
+			xSemaphoreGive(s_lock);
+		}
+		waited = true;
+		vTaskDelay(pdMS_TO_TICKS(STORE_WINDOW_POLL_MS) ? pdMS_TO_TICKS(STORE_WINDOW_POLL_MS) : 1);
+	}
+	ESP_MENU_TRACE_END(ESP_MENU_TRACE_NVS_WAIT, forced);
+	if (waited) {
+		uint32_t wait_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+		s_stats.deferred++;
+		if (wait_ms > s_stats.max_wait_ms) {
+			s_stats.max_wait_ms = wait_ms;
+		}
+	}
+	if (forced) {
+		ESP_LOGW(TAG, "No write window for %d ms, writing anyway", (int)(STORE_MAX_DEFER_US / 1000));
+		s_stats.forced++;
+	}
+}
+
+/**
+ * @brief Whether any parameter is waiting to be written.
+ */
+static bool store_has_dirty(void) {
+#ifdef CONFIG_ESPMENU_STORE_BLOB
+	if (s_blob_stale) {
+		return true;
+	}
+#endif
+	for (uint16_t w = 0; w < STORE_WORDS(s_count); w++) {
+		if (__atomic_load_n(&s_dirty[w], __ATOMIC_ACQUIRE)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Write every dirty parameter whose value differs from flash, then commit once.
+ */
+static esp_err_t store_write_dirty(void) {
+	if (!store_has_dirty()) {
+		return ESP_OK;  // Nothing to write: do not wait for a window
+	}
+	store_enter_window();
+	s_stats.flushes++;
+#ifdef CONFIG_ESPMENU_STORE_BLOB
+	esp_err_t ret = store_write_blob();
+#else
+	esp_err_t ret = store_write_keys();
+#endif
+	xSemaphoreGive(s_lock);
+	return ret;
+}
+
+/**
+ * @brief NVS key of a favorite slot.
+ */
+static void store_fav_key(uint8_t slot, char *key, size_t len) {
+	snprintf(key, len, "fav_slot_%u", (unsigned)slot);
+}
+
+/**
+ * @brief Write or erase every pending favorite slot, then commit once.
+ */
+static esp_err_t store_write_favs(void) {
+	uint32_t pending = __atomic_exchange_n(&s_fav_pending, 0, __ATOMIC_ACQ_REL);
+	uint32_t done = 0;
+	esp_err_t ret = ESP_OK;
+	while (pending) {
+		uint8_t slot = __builtin_ctz(pending);
+		uint32_t bit = 1u << slot;
+		pending &= pending - 1;
+		char key[16];
+		store_fav_key(slot, key, sizeof(key));
+		store_blob_entry_t *entries = (store_blob_entry_t *)(s_fav_buf + 1);
+		const int32_t *row = &s_favs[slot * s_count];
+		uint16_t n = 0;
+		portENTER_CRITICAL(&s_fav_lock);
+		bool used = s_fav_used & bit;
+		for (uint16_t id = 0; used && id < s_count; id++) {
+			if (s_hashes[id]) {
+				entries[n].key_hash = s_hashes[id];
+				entries[n++].value = row[id];
+			}
+		}
+		portEXIT_CRITICAL(&s_fav_lock);
+		s_fav_buf[0] = STORE_FAV_MAGIC;
+		esp_err_t err = used ? nvs_set_blob(s_nvs, key, s_fav_buf,
+											sizeof(uint32_t) + n * sizeof(store_blob_entry_t))
+							 : nvs_erase_key(s_nvs, key);
+		if (err == ESP_ERR_NVS_NOT_FOUND) {
+			err = ESP_OK;
+		}
+		if (err != ESP_OK) {
+			ESP_LOGW(TAG, "Writing %s failed: %s", key, esp_err_to_name(err));
+			__atomic_fetch_or(&s_fav_pending, bit, __ATOMIC_RELEASE);
+			s_stats.errors++;
+			ret = ret == ESP_OK ? err : ret;
+			continue;
+		}
+		done |= bit;
+	}
+	if (done) {
+		ESP_MENU_TRACE_BEGIN(ESP_MENU_TRACE_NVS_COMMIT, __builtin_popcount(done));
+		esp_err_t err = nvs_commit(s_nvs);
+		ESP_MENU_TRACE_END(ESP_MENU_TRACE_NVS_COMMIT, __builtin_popcount(done));
+		if (err == ESP_OK) {
+			s_stats.commits++;
+			s_stats.keys_written += __builtin_popcount(done);
+		} else {
+			ESP_LOGW(TAG, "nvs_commit failed: %s", esp_err_to_name(err));
+			__atomic_fetch_or(&s_fav_pending, done, __ATOMIC_RELEASE);
+			s_stats.errors++;
+			ret = ret == ESP_OK ? err : ret;
+		}
+	}
+	return ret;
+}
+
+/**
+ * @brief Write pending favorite slots inside a write window.
+ */
+static esp_err_t store_flush_favs(void) {
+	if (!__atomic_load_n(&s_fav_pending, __ATOMIC_ACQUIRE)) {
+		return ESP_OK;
+	}
+	store_enter_window();
+	esp_err_t ret = store_write_favs();
+	xSemaphoreGive(s_lock);
+	return ret;
+}
+
+/**
+ * @brief Read one favorite body into its cache row.
+ *
+ * Parameters the body does not hold start at their default.
+ *
+ * @return esp_err_t ESP_OK if the row was filled, ESP_ERR_NVS_NOT_FOUND for
+ *         an empty slot, ESP_ERR_INVALID_SIZE for an unusable body.
+ */
+static esp_err_t store_load_fav(const char *key, int32_t *row) {
+	size_t len = 0;
+	esp_err_t err = nvs_get_blob(s_nvs, key, NULL, &len);
+	if (err != ESP_OK) {
+		return err;
+	}
+	if (len < sizeof(uint32_t)) {
+		return ESP_ERR_INVALID_SIZE;
+	}
+	uint32_t *buf = heap_caps_malloc(len, MALLOC_CAP_DEFAULT);
+	if (!buf) {
+		return ESP_ERR_NO_MEM;
+	}
+	err = nvs_get_blob(s_nvs, key, buf, &len);
+	size_t entries = (len - sizeof(uint32_t)) / sizeof(store_blob_entry_t);
+	if (err == ESP_OK && buf[0] == STORE_FAV_MAGIC &&
+		len == sizeof(uint32_t) + entries * sizeof(store_blob_entry_t)) {
+		const store_blob_entry_t *entry = (const store_blob_entry_t *)(buf + 1);
+		for (uint16_t id = 0; id < s_count; id++) {
+			row[id] = esp_menu_param_get_desc(id)->def;
+			for (size_t e = 0; s_hashes[id] && e < entries; e++) {
+				if (entry[e].key_hash == s_hashes[id]) {
+					row[id] = entry[e].value;
+					break;
+				}
+			}
+		}
+	} else if (err == ESP_OK) {
+		err = ESP_ERR_INVALID_SIZE;
+	}
+	heap_caps_free(buf);
+	return err;
+}
+
+/**
+ * @brief Read every favorite slot into the cache.
+ */
+static void store_load_favs(void) {
+	uint32_t used = 0;
+	for (uint8_t slot = 0; slot < STORE_FAV_SLOTS; slot++) {
+		char key[16];
+		store_fav_key(slot, key, sizeof(key));
+		esp_err_t err = store_load_fav(key, &s_favs[slot * s_count]);
+		if (err == ESP_OK) {
+			used |= 1u << slot;
+		} else if (err != ESP_ERR_NVS_NOT_FOUND) {
+			ESP_LOGW(TAG, "Dropping %s: %s", key, esp_err_to_name(err));
+		}
+	}
+	s_fav_used = used;
+}
+
+/**
+ * @brief Parameter observer: mark dirty and restart the quiet period.
+ */
+static void store_on_change(uint16_t id, int32_t value) {
+	(void)value;
+	const esp_menu_param_desc_t *desc = esp_menu_param_get_desc(id);
+	if (!desc || !desc->nvs_key || id >= s_count) {
+		return;
+	}
+	__atomic_fetch_or(&s_dirty[id / 32], 1u << (id % 32), __ATOMIC_RELEASE);
+#ifdef CONFIG_ESPMENU_AUTO_SAVE
+	const uint64_t delay_us = (uint64_t)CONFIG_ESPMENU_AUTO_SAVE_DELAY_MS * 1000;
+	if (esp_timer_restart(s_debounce, delay_us) != ESP_OK) {
+		esp_timer_start_once(s_debounce, delay_us);
+	}
+#endif
+}
+
+#ifdef CONFIG_ESPMENU_AUTO_SAVE
+/**
+ * @brief Quiet period elapsed; hand the write to the worker.
+ */
+static void store_debounce_cb(void *arg) {
+	(void)arg;
+	xTaskNotify(s_task, STORE_EVT_FLUSH, eSetBits);
+}
+#endif
+
+/**
+ * @brief Low-priority worker that performs the NVS writes.
+ */
+static void store_task(void *arg) {
+	(void)arg;
+	for (;;) {
+		uint32_t events = 0;
+		xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
+		if (events & STORE_EVT_FLUSH) {
+			store_write_dirty();
+		}
+		if (events & STORE_EVT_FAV) {
+			store_flush_favs();
+		}
+		// Drain on exit too, so every posted job runs and can free its argument
+		store_job_t job;
+		while ((events & (STORE_EVT_JOB | STORE_EVT_EXIT)) && xQueueReceive(s_jobs, &job, 0) == pdTRUE) {
+			store_enter_window();
+			if (job.job(job.arg) != ESP_OK) {
+				s_stats.errors++;
+			}
+			xSemaphoreGive(s_lock);
+		}
+		if (events & STORE_EVT_EXIT) {
+			break;
+		}
+	}
+	xTaskNotifyGive(s_waiter);
+	vTaskDelete(NULL);
+}
+
+/**
+ * @brief Release everything allocated by esp_menu_store_init().
+ */
+static void store_release(void) {
+#ifdef CONFIG_ESPMENU_AUTO_SAVE
+	if (s_debounce) {
+		esp_timer_stop(s_debounce);
+		esp_timer_delete(s_debounce);
+		s_debounce = NULL;
+	}
+#endif
+	if (s_lock) {
+		vSemaphoreDelete(s_lock);
+		s_lock = NULL;
+	}
+	if (s_jobs) {
+		vQueueDelete(s_jobs);
+		s_jobs = NULL;
+	}
+	if (s_nvs) {
+		nvs_close(s_nvs);
+		s_nvs = 0;
+	}
+	heap_caps_free(s_dirty);
+	s_dirty = NULL;
+	s_favs = NULL;
+	s_fav_buf = NULL;
+	s_fav_used = 0;
+	s_fav_pending = 0;
+	s_inflight = NULL;
+	s_persisted = NULL;
+	s_written = NULL;
+	s_hashes = NULL;
+	s_keyed = 0;
+	s_count = 0;
+}
+
+esp_err_t esp_menu_store_load(void) {
+	if (!s_lock) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	xSemaphoreTake(s_lock, portMAX_DELAY);
+	uint16_t loaded = 0;
+#ifdef CONFIG_ESPMENU_STORE_BLOB
+	esp_err_t err = store_load_blob(&loaded);
+	if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+		// Torn or foreign record: trust nothing in it
+		ESP_LOGW(TAG, "Parameter record unusable (%s), using defaults", esp_err_to_name(err));
+		esp_menu_param_reset_defaults();
+		s_blob_stale = true;
+	} else if (err == ESP_ERR_NVS_NOT_FOUND) {
+		s_blob_stale = true;
+	}
+	// No record yet: migrate values saved one key at a time
+	for (uint16_t id = 0; err == ESP_ERR_NVS_NOT_FOUND && id < s_count; id++) {
+#else
+	for (uint16_t id = 0; id < s_count; id++) {
+#endif
+		const esp_menu_param_desc_t *desc = esp_menu_param_get_desc(id);
+		int32_t value;
+		if (!desc->nvs_key || store_get(desc, &value) != ESP_OK) {
+			continue;
+		}
+		esp_menu_param_set(id, value);
+		s_persisted[id] = value;
+		loaded++;
+	}
+#ifdef CONFIG_ESPMENU_STORE_BLOB
+	if (s_blob_stale && s_task) {
+		xTaskNotify(s_task, STORE_EVT_FLUSH, eSetBits);
+	}
+#endif
+	xSemaphoreGive(s_lock);
+	ESP_LOGI(TAG, "Loaded %u of %u parameters", (unsigned)loaded, (unsigned)s_count);
+	return ESP_OK;
+}
+
+esp_err_t esp_menu_store_init(void) {
+	if (s_lock) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	uint16_t count = esp_menu_param_count();
+	if (count == 0) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	// One block: dirty and in-flight bitmasks, persisted and written values, key hashes
+	size_t words = STORE_WORDS(count);
+	size_t block_words = 2 * words + 3 * count;
+	if (STORE_FAV_SLOTS) {
+		// Favorite cache, then the worker copy: magic and up to count entries
+		block_words += STORE_FAV_SLOTS * count + 1 + 2 * count;
+	}
+	uint32_t *block = heap_caps_calloc(block_words, sizeof(uint32_t), MALLOC_CAP_DEFAULT);
+	if (!block) {
+		return ESP_ERR_NO_MEM;
+	}
+	s_count = count;
+	s_dirty = block;
+	s_inflight = block + words;
+	s_persisted = (int32_t *)(block + 2 * words);
+	s_written = s_persisted + count;
+	memset(&s_stats, 0, sizeof(s_stats));
+	s_hashes = (uint32_t *)(s_written + count);
+	s_keyed = 0;
+	for (uint16_t id = 0; id < count; id++) {
+		s_hashes[id] = esp_menu_param_key_hash(id);
+		s_keyed += s_hashes[id] != 0;
+	}
+	if (STORE_FAV_SLOTS) {
+		s_favs = (int32_t *)(s_hashes + count);
+		s_fav_buf = (uint32_t *)(s_favs + STORE_FAV_SLOTS * count);
+	}
+#ifdef CONFIG_ESPMENU_STORE_BLOB
+	s_blob_stale = false;
+#endif
+
+	esp_err_t err = nvs_open(CONFIG_ESPMENU_NVS_NAMESPACE, NVS_READWRITE, &s_nvs);
+	if (err != ESP_OK) {
+		ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(err));
+		s_nvs = 0;
+		store_release();
+		return err;
+	}
+	s_lock = xSemaphoreCreateMutex();
+	s_jobs = xQueueCreate(STORE_JOB_QUEUE_LEN, sizeof(store_job_t));
+	if (!s_lock || !s_jobs) {
+		store_release();
+		return ESP_ERR_NO_MEM;
+	}
+	// Values not in flash yet must be written on their first change
+	for (uint16_t id = 0; id < count; id++) {
+		s_persisted[id] = esp_menu_param_get(id);
+	}
+	esp_menu_store_load();
+	if (STORE_FAV_SLOTS) {
+		store_load_favs();
+	}
+
+#ifdef CONFIG_ESPMENU_AUTO_SAVE
+	const esp_timer_create_args_t timer_args = {
+		.callback = store_debounce_cb,
+		.name = "menu_save",
+	};
+	err = esp_timer_create(&timer_args, &s_debounce);
+	if (err != ESP_OK) {
+		store_release();
+		return err;
+	}
+#endif
+	if (xTaskCreate(store_task, "menu_store", CONFIG_ESPMENU_STORE_TASK_STACK, NULL,
+					CONFIG_ESPMENU_STORE_TASK_PRIORITY, &s_task) != pdPASS) {
+		s_task = NULL;
+		store_release();
+		return ESP_ERR_NO_MEM;
+	}
+	// Observe only after loading, so restoring values does not mark them dirty
+	esp_menu_param_set_observer(store_on_change);
+#ifdef CONFIG_ESPMENU_STORE_BLOB
+	if (s_blob_stale) {
+		xTaskNotify(s_task, STORE_EVT_FLUSH, eSetBits);
+	}
+#endif
+	return ESP_OK;
+}
+
+void esp_menu_store_deinit(void) {
+	if (!s_lock) {
+		return;
+	}
+	esp_menu_param_set_observer(NULL);
+#ifdef CONFIG_ESPMENU_AUTO_SAVE
+	esp_timer_stop(s_debounce);
+#endif
+	if (s_task) {
+		s_waiter = xTaskGetCurrentTaskHandle();
+		xTaskNotify(s_task, STORE_EVT_FLUSH | STORE_EVT_FAV | STORE_EVT_EXIT, eSetBits);
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		s_task = NULL;
+		s_waiter = NULL;
+	}
+	store_release();
+}
+
+esp_err_t esp_menu_store_flush(void) {
+	if (!s_task) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	xTaskNotify(s_task, STORE_EVT_FLUSH, eSetBits);
+	return ESP_OK;
+}
+
+esp_err_t esp_menu_store_sync(void) {
+	if (!s_lock) {
+		return ESP_ERR_INVALID_STATE;
+	}
+#ifdef CONFIG_ESPMENU_AUTO_SAVE
+	esp_timer_stop(s_debounce);
+#endif
+	esp_err_t ret = store_write_dirty();
+	esp_err_t err = store_flush_favs();
+	return ret == ESP_OK ? err : ret;
+}
+
+esp_err_t esp_menu_store_get_stats(esp_menu_store_stats_t *out) {
+	if (!out) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	*out = s_stats;
+	return ESP_OK;
+}
+
+void esp_menu_store_set_window_cb(esp_menu_store_window_cb_t cb, void *ctx) {
+	portENTER_CRITICAL(&s_window_lock);
+	s_window_cb = cb;
+	s_window_ctx = ctx;
+	portEXIT_CRITICAL(&s_window_lock);
+}
+
+void esp_menu_store_set_rt_task(TaskHandle_t task) {
+	portENTER_CRITICAL(&s_window_lock);
+	s_rt_task = task;
+	portEXIT_CRITICAL(&s_window_lock);
+}
+
+esp_err_t esp_menu_store_post(esp_menu_store_job_t job, void *arg) {
+	if (!job) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (!s_task) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	store_job_t item = {.job = job, .arg = arg};
+	if (xQueueSend(s_jobs, &item, 0) != pdTRUE) {
+		return ESP_ERR_TIMEOUT;
+	}
+	xTaskNotify(s_task, STORE_EVT_JOB, eSetBits);
+	return ESP_OK;
+}
+
+/**
+ * @brief Update the cache for @p slot and hand the write to the worker.
+ */
+static esp_err_t store_fav_update(uint8_t slot, bool save) {
+	if (!s_task) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	if (slot >= STORE_FAV_SLOTS) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	int32_t *row = &s_favs[slot * s_count];
+	portENTER_CRITICAL(&s_fav_lock);
+	if (save) {
+		for (uint16_t id = 0; id < s_count; id++) {
+			row[id] = esp_menu_param_get(id);
+		}
+		s_fav_used |= 1u << slot;
+	} else {
+		s_fav_used &= ~(1u << slot);
+	}
+	portEXIT_CRITICAL(&s_fav_lock);
+	__atomic_fetch_or(&s_fav_pending, 1u << slot, __ATOMIC_RELEASE);
+	xTaskNotify(s_task, STORE_EVT_FAV, eSetBits);
+	return ESP_OK;
+}
+
+esp_err_t esp_menu_store_fav_save(uint8_t slot) {
+	return store_fav_update(slot, true);
+}
+
+esp_err_t esp_menu_store_fav_clear(uint8_t slot) {
+	return store_fav_update(slot, false);
+}
+
+esp_err_t esp_menu_store_fav_load(uint8_t slot) {
+	if (!s_task) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	if (slot >= STORE_FAV_SLOTS) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (!esp_menu_store_fav_used(slot)) {
+		return ESP_ERR_NOT_FOUND;
+	}
+	const int32_t *row = &s_favs[slot * s_count];
+	for (uint16_t id = 0; id < s_count; id++) {
+		portENTER_CRITICAL(&s_fav_lock);
+		bool used = s_fav_used & (1u << slot);
+		int32_t value = row[id];
+		portEXIT_CRITICAL(&s_fav_lock);
+		if (!used) {
+			return ESP_ERR_NOT_FOUND;
+		}
+		// Only parameters with an NVS key are part of the flash copy of a slot
+		if (s_hashes[id]) {
+			// Changed values are marked dirty and written behind like any edit
+			esp_menu_param_set(id, value);
+		}
+	}
+	return ESP_OK;
+}
+
+bool esp_menu_store_fav_used(uint8_t slot) {
+	return slot < STORE_FAV_SLOTS && (__atomic_load_n(&s_fav_used, __ATOMIC_ACQUIRE) & (1u << slot));
+}
+
+#else  // CONFIG_ESPMENU_ENABLE_NVS
+
+esp_err_t esp_menu_store_init(void) {
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+void esp_menu_store_deinit(void) {}
+
+esp_err_t esp_menu_store_load(void) {
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_menu_store_flush(void) {
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_menu_store_sync(void) {
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_menu_store_get_stats(esp_menu_store_stats_t *out) {
+	if (!out) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	memset(out, 0, sizeof(*out));
+	return ESP_OK;
+}
+
+void esp_menu_store_set_window_cb(esp_menu_store_window_cb_t cb, void *ctx) {
+	(void)cb;
+	(void)ctx;
+}
+
+void esp_menu_store_set_rt_task(TaskHandle_t task) {
+	(void)task;
+}
+
+esp_err_t esp_menu_store_post(esp_menu_store_job_t job, void *arg) {
+	(void)job;
+	(void)arg;
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_menu_store_fav_save(uint8_t slot) {
+	(void)slot;
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_menu_store_fav_load(uint8_t slot) {
+	(void)slot;
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_menu_store_fav_clear(uint8_t slot) {
+	(void)slot;
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+bool esp_menu_store_fav_used(uint8_t slot) {
+	(void)slot;
+	return false;
+}
+
+#endif  // CONFIG_ESPMENU_ENABLE_NVS
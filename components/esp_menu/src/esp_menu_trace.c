@@ -0,0 +1,221 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_trace.c
+ * @brief Per-core trace rings and their Chrome trace-event dump.
+ */
+
+#include "esp_menu_trace.h"
+#include "esp_console.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+static const char *const s_names[ESP_MENU_TRACE_IDS] = {
+	[ESP_MENU_TRACE_INPUT] = "input",
+	[ESP_MENU_TRACE_READ] = "read",
+	[ESP_MENU_TRACE_DISPATCH] = "dispatch",
+	[ESP_MENU_TRACE_ACTION] = "action",
+	[ESP_MENU_TRACE_NVS_WAIT] = "nvs_wait",
+	[ESP_MENU_TRACE_NVS_COMMIT] = "nvs_commit",
+	[ESP_MENU_TRACE_RENDER] = "render",
+	[ESP_MENU_TRACE_FLUSH] = "flush",
+	[ESP_MENU_TRACE_BUS] = "bus",
+	[ESP_MENU_TRACE_IDLE] = "idle",
+};
+
+const char *esp_menu_trace_name(esp_menu_trace_id_t id) {
+	return id < ESP_MENU_TRACE_IDS ? s_names[id] : "?";
+}
+
+#ifdef CONFIG_ESPMENU_TRACE
+
+#define TRACE_DEPTH CONFIG_ESPMENU_TRACE_DEPTH
+_Static_assert((TRACE_DEPTH & (TRACE_DEPTH - 1)) == 0, "ESPMENU_TRACE_DEPTH must be a power of two");
+
+/** @brief Tasks whose names are remembered for the dump; later ones show as a number. */
+#define TRACE_TASKS 16
+
+/** @brief One recorded event, 16 bytes. */
+typedef struct {
+	uint32_t ts;        ///< esp_timer_get_time(), low 32 bits
+	int32_t arg;
+	TaskHandle_t task;  ///< Emitting task, the row in the dump
+	uint8_t id;         ///< esp_menu_trace_id_t
+	char phase;         ///< 'B', 'E' or 'i'
+	uint16_t reserved;
+} trace_event_t;
+
+/** @brief Ring of one core; only ever written through an atomically claimed slot. */
+typedef struct {
+	uint32_t head;  ///< Events ever claimed on this core; the next slot is head % TRACE_DEPTH
+	trace_event_t events[TRACE_DEPTH];
+} trace_ring_t;
+
+/** @brief Name copied when a task first emits, so deleted tasks still get their row name. */
+typedef struct {
+	TaskHandle_t task;  ///< Published after the name is written
+	char name[configMAX_TASK_NAME_LEN];
+} trace_task_t;
+
+static trace_ring_t s_rings[portNUM_PROCESSORS];
+static trace_task_t s_tasks[TRACE_TASKS];
+static uint32_t s_task_count = 0;
+static bool s_enabled = true;
+
+/**
+ * @brief Remember the name of the calling task the first time it emits.
+ *
+ * A task runs on one core at a time and never races itself, so a lookup
+ * miss followed by a claim cannot register the same task twice.
+ */
+static void trace_note_task(TaskHandle_t task) {
+	uint32_t count = __atomic_load_n(&s_task_count, __ATOMIC_ACQUIRE);
+	for (uint32_t i = 0; i < count && i < TRACE_TASKS; i++) {
+		if (__atomic_load_n(&s_tasks[i].task, __ATOMIC_ACQUIRE) == task) {
+			return;
+		}
+	}
+	if (count >= TRACE_TASKS) {
+		return;
+	}
+	uint32_t slot = __atomic_fetch_add(&s_task_count, 1, __ATOMIC_ACQ_REL);
+	if (slot >= TRACE_TASKS) {
+		return;
+	}
+	strncpy(s_tasks[slot].name, pcTaskGetName(NULL), sizeof(s_tasks[slot].name) - 1);
+	__atomic_store_n(&s_tasks[slot].task, task, __ATOMIC_RELEASE);
+}
+
+void esp_menu_trace_emit(esp_menu_trace_id_t id, char phase, int32_t arg) {
+	if (!__atomic_load_n(&s_enabled, __ATOMIC_RELAXED)) {
+		return;
+	}
+	TaskHandle_t task = xTaskGetCurrentTaskHandle();
+	trace_note_task(task);
+	// A task moved to the other core after this still claims its slot atomically
+	trace_ring_t *ring = &s_rings[xPortGetCoreID()];
+	uint32_t slot = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED) & (TRACE_DEPTH - 1);
+	ring->events[slot] = (trace_event_t){
+		.ts = (uint32_t)esp_timer_get_time(),
+		.arg = arg,
+		.task = task,
+		.id = (uint8_t)id,
+		.phase = phase,
+	};
+}
+
+void esp_menu_trace_enable(bool enable) {
+	__atomic_store_n(&s_enabled, enable, __ATOMIC_RELEASE);
+}
+
+void esp_menu_trace_clear(void) {
+	for (int core = 0; core < portNUM_PROCESSORS; core++) {
+		__atomic_store_n(&s_rings[core].head, 0, __ATOMIC_RELEASE);
+	}
+}
+
+static void trace_sep(FILE *out, bool *first) {
+	fputs(*first ? "\n" : ",\n", out);
+	*first = false;
+}
+
+esp_err_t esp_menu_trace_dump(FILE *out) {
+	if (!out) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	bool was_enabled = __atomic_exchange_n(&s_enabled, false, __ATOMIC_ACQ_REL);
+	int64_t now = esp_timer_get_time();
+	bool first = true;
+
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", out);
+	uint32_t tasks = __atomic_load_n(&s_task_count, __ATOMIC_ACQUIRE);
+	for (uint32_t i = 0; i < tasks && i < TRACE_TASKS; i++) {
+		TaskHandle_t task = __atomic_load_n(&s_tasks[i].task, __ATOMIC_ACQUIRE);
+		if (!task) {
+			continue;
+		}
+		trace_sep(out, &first);
+		fprintf(out,
+				"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%lu,"
+				"\"args\":{\"name\":\"%s\"}}",
+				(unsigned long)(uintptr_t)task, s_tasks[i].name);
+	}
+	for (int core = 0; core < portNUM_PROCESSORS; core++) {
+		const trace_ring_t *ring = &s_rings[core];
+		uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		uint32_t count = head < TRACE_DEPTH ? head : TRACE_DEPTH;
+		for (uint32_t n = head - count; n != head; n++) {
+			const trace_event_t *ev = &ring->events[n & (TRACE_DEPTH - 1)];
+			if (ev->id >= ESP_MENU_TRACE_IDS) {
+				continue;
+			}
+			// Widen the stored low 32 bits against the current time
+			int64_t ts = now - (uint32_t)((uint32_t)now - ev->ts);
+			trace_sep(out, &first);
+			fprintf(out,
+					"{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":0,\"tid\":%lu,%s"
+					"\"args\":{\"core\":%d,\"arg\":%ld}}",
+					s_names[ev->id], ev->phase, (long long)ts, (unsigned long)(uintptr_t)ev->task,
+					ev->phase == 'i' ? "\"s\":\"t\"," : "", core, (long)ev->arg);
+		}
+	}
+	fputs("\n]}\n", out);
+	fflush(out);
+	__atomic_store_n(&s_enabled, was_enabled, __ATOMIC_RELEASE);
+	return ESP_OK;
+}
+
+static int trace_cmd(int argc, char **argv) {
+	if (argc == 1 || strcmp(argv[1], "dump") == 0) {
+		return esp_menu_trace_dump(stdout) == ESP_OK ? 0 : 1;
+	}
+	if (strcmp(argv[1], "clear") == 0) {
+		esp_menu_trace_clear();
+	} else if (strcmp(argv[1], "stop") == 0) {
+		esp_menu_trace_enable(false);
+	} else if (strcmp(argv[1], "start") == 0) {
+		esp_menu_trace_enable(true);
+	} else {
+		printf("usage: %s [dump|clear|stop|start]\n", argv[0]);
+		return 1;
+	}
+	return 0;
+}
+
+esp_err_t esp_menu_trace_register_console(void) {
+	const esp_console_cmd_t cmd = {
+		.command = "menu_trace",
+		.help = "Print the esp_menu timeline as Chrome trace JSON; 'clear', 'stop' and 'start' "
+				"control recording",
+		.hint = "[dump|clear|stop|start]",
+		.func = trace_cmd,
+	};
+	return esp_console_cmd_register(&cmd);
+}
+
+#else
+
+void esp_menu_trace_emit(esp_menu_trace_id_t id, char phase, int32_t arg) {
+	(void)id;
+	(void)phase;
+	(void)arg;
+}
+
+void esp_menu_trace_enable(bool enable) {
+	(void)enable;
+}
+
+void esp_menu_trace_clear(void) {
+}
+
+esp_err_t esp_menu_trace_dump(FILE *out) {
+	(void)out;
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_menu_trace_register_console(void) {
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif  // CONFIG_ESPMENU_TRACE
@@ -0,0 +1,274 @@
+// Copyright 2025 james-l-key
+/**
+ * @file esp_menu_vlist.c
+ * @brief Virtualized list: a fixed pool of row objects recycled over a logical item range.
+ */
+
+#include "esp_menu_vlist.h"
+#include "sdkconfig.h"
+#include <string.h>
+
+/** @brief Rows kept beyond the visible ones so a partially shown row is populated. */
+#define VLIST_MARGIN_ROWS 1
+/** @brief Scratch buffer size for formatted row text. */
+#define VLIST_TEXT_MAX 32
+
+#ifdef CONFIG_ESPMENU_VLIST_ROW_HEIGHT
+#define VLIST_ROW_HEIGHT CONFIG_ESPMENU_VLIST_ROW_HEIGHT
+#else
+#define VLIST_ROW_HEIGHT 14
+#endif
+
+/** @brief LVGL objects making up one recycled row. */
+typedef struct {
+	lv_obj_t *row;
+	lv_obj_t *icon;
+	lv_obj_t *label;
+} vlist_row_t;
+
+/** @brief Per-widget state, owned by the list object and freed on delete. */
+typedef struct {
+	esp_menu_vlist_config_t cfg;
+	uint32_t first;         ///< Logical index shown in row 0
+	uint32_t selected;      ///< Selected logical index
+	uint8_t visible_rows;   ///< Rows fully on screen
+	uint8_t row_count;      ///< Rows allocated (visible + margin)
+	char buf[VLIST_TEXT_MAX];
+	vlist_row_t rows[];
+} vlist_ctx_t;
+
+static lv_style_t s_style_row;
+static lv_style_t s_style_selected;
+static bool s_styles_inited = false;
+
+/**
+ * @brief Row styles matching the engine's focus look on monochrome OLED.
+ */
+static void vlist_init_styles(void) {
+	if (s_styles_inited) {
+		return;
+	}
+	lv_style_init(&s_style_row);
+	lv_style_set_bg_opa(&s_style_row, LV_OPA_TRANSP);
+	lv_style_set_border_width(&s_style_row, 0);
+	lv_style_set_radius(&s_style_row, 0);
+	lv_style_set_pad_top(&s_style_row, 1);
+	lv_style_set_pad_bottom(&s_style_row, 1);
+	lv_style_set_pad_left(&s_style_row, 4);
+	lv_style_set_pad_right(&s_style_row, 4);
+	lv_style_set_pad_column(&s_style_row, 4);
+
+	lv_style_init(&s_style_selected);
+	lv_style_set_bg_opa(&s_style_selected, LV_OPA_COVER);
+	lv_style_set_bg_color(&s_style_selected, lv_color_white());
+	lv_style_set_text_color(&s_style_selected, lv_color_black());
+	s_styles_inited = true;
+}
+
+/**
+ * @brief Fill one row from the content callback, or hide it past the end.
+ */
+static void vlist_bind_row(vlist_ctx_t *ctx, uint8_t r) {
+	vlist_row_t *row = &ctx->rows[r];
+	uint32_t index = ctx->first + r;
+	if (index >= ctx->cfg.item_count) {
+		lv_obj_add_flag(row->row, LV_OBJ_FLAG_HIDDEN);
+		return;
+	}
+	esp_menu_vlist_row_t content = {
+		.text = "",
+		.icon = NULL,
+		.buf = ctx->buf,
+		.buf_size = sizeof(ctx->buf),
+	};
+	ctx->cfg.fill_cb(index, &content, ctx->cfg.user_ctx);
+
+	if (content.text == ctx->buf) {
+		lv_label_set_text(row->label, content.text);
+	} else {
+		lv_label_set_text_static(row->label, content.text ? content.text : "");
+	}
+	if (content.icon) {
+		lv_image_set_src(row->icon, content.icon);
+		lv_obj_remove_flag(row->icon, LV_OBJ_FLAG_HIDDEN);
+	} else {
+		lv_obj_add_flag(row->icon, LV_OBJ_FLAG_HIDDEN);
+	}
+	if (index == ctx->selected) {
+		lv_obj_add_state(row->row, LV_STATE_CHECKED);
+	} else {
+		lv_obj_remove_state(row->row, LV_STATE_CHECKED);
+	}
+	lv_obj_remove_flag(row->row, LV_OBJ_FLAG_HIDDEN);
+}
+
+/**
+ * @brief Refill every row; cost is O(rows), independent of the item count.
+ */
+static void vlist_bind_all(vlist_ctx_t *ctx) {
+	for (uint8_t r = 0; r < ctx->row_count; r++) {
+		vlist_bind_row(ctx, r);
+	}
+}
+
+/**
+ * @brief Move the selection to @p index, scrolling the window only when needed.
+ */
+static void vlist_select(vlist_ctx_t *ctx, uint32_t index) {
+	if (ctx->cfg.item_count == 0) {
+		ctx->selected = 0;
+		ctx->first = 0;
+		vlist_bind_all(ctx);
+		return;
+	}
+	if (index >= ctx->cfg.item_count) {
+		index = ctx->cfg.item_count - 1;
+	}
+	uint32_t old = ctx->selected;
+	uint32_t first = ctx->first;
+	if (index < first) {
+		first = index;
+	} else if (index >= first + ctx->visible_rows) {
+		first = index - ctx->visible_rows + 1;
+	}
+	ctx->selected = index;
+
+	if (first != ctx->first) {
+		ctx->first = first;
+		vlist_bind_all(ctx);
+		return;
+	}
+	// Window unchanged: only the two affected rows change state
+	if (old >= first && old - first < ctx->row_count) {
+		lv_obj_remove_state(ctx->rows[old - first].row, LV_STATE_CHECKED);
+	}
+	lv_obj_add_state(ctx->rows[index - first].row, LV_STATE_CHECKED);
+}
+
+/**
+ * @brief Key, click and delete handling for the list object.
+ */
+static void vlist_event_cb(lv_event_t *e) {
+	vlist_ctx_t *ctx = lv_event_get_user_data(e);
+	switch (lv_event_get_code(e)) {
+	case LV_EVENT_KEY: {
+		if (ctx->cfg.item_count == 0) {
+			break;
+		}
+		uint32_t key = lv_event_get_key(e);
+		if (ctx->cfg.key_cb && ctx->cfg.key_cb(ctx->selected, key, ctx->cfg.user_ctx)) {
+			break;
+		}
+		uint32_t last = ctx->cfg.item_count - 1;
+		if (key == LV_KEY_RIGHT || key == LV_KEY_DOWN) {
+			vlist_select(ctx, ctx->selected < last ? ctx->selected + 1 : 0);
+		} else if (key == LV_KEY_LEFT || key == LV_KEY_UP) {
+			vlist_select(ctx, ctx->selected > 0 ? ctx->selected - 1 : last);
+		}
+		break;
+	}
+	case LV_EVENT_CLICKED:
+		if (ctx->cfg.click_cb && ctx->selected < ctx->cfg.item_count) {
+			ctx->cfg.click_cb(ctx->selected, ctx->cfg.user_ctx);
+		}
+		break;
+	case LV_EVENT_DELETE:
+		lv_free(ctx);
+		break;
+	default:
+		break;
+	}
+}
+
+lv_obj_t *esp_menu_vlist_create(lv_obj_t *parent, const esp_menu_vlist_config_t *cfg) {
+	if (!parent || !cfg || !cfg->fill_cb) {
+		return NULL;
+	}
+	uint8_t visible = cfg->visible_rows;
+	if (visible == 0) {
+		lv_obj_update_layout(parent);
+		int32_t h = lv_obj_get_content_height(parent) / VLIST_ROW_HEIGHT;
+		visible = h > 0 ? (uint8_t)(h < UINT8_MAX - VLIST_MARGIN_ROWS ? h : UINT8_MAX - VLIST_MARGIN_ROWS) : 1;
+	}
+	uint8_t row_count = visible + VLIST_MARGIN_ROWS;
+
+	vlist_ctx_t *ctx = lv_malloc_zeroed(sizeof(*ctx) + row_count * sizeof(vlist_row_t));
+	if (!ctx) {
+		return NULL;
+	}
+	ctx->cfg = *cfg;
+	ctx->visible_rows = visible;
+	ctx->row_count = row_count;
+	vlist_init_styles();
+
+	lv_obj_t *vlist = lv_obj_create(parent);
+	if (!vlist) {
+		lv_free(ctx);
+		return NULL;
+	}
+	lv_obj_set_size(vlist, LV_PCT(100), LV_PCT(100));
+	lv_obj_remove_flag(vlist, LV_OBJ_FLAG_SCROLLABLE);
+	lv_obj_set_style_pad_all(vlist, 0, 0);
+	lv_obj_set_style_border_width(vlist, 0, 0);
+	lv_obj_set_user_data(vlist, ctx);
+
+	for (uint8_t r = 0; r < row_count; r++) {
+		vlist_row_t *row = &ctx->rows[r];
+		row->row = lv_obj_create(vlist);
+		lv_obj_remove_style_all(row->row);
+		lv_obj_add_style(row->row, &s_style_row, 0);
+		lv_obj_add_style(row->row, &s_style_selected, LV_STATE_CHECKED);
+		lv_obj_set_size(row->row, LV_PCT(100), VLIST_ROW_HEIGHT);
+		lv_obj_set_pos(row->row, 0, r * VLIST_ROW_HEIGHT);
+		lv_obj_remove_flag(row->row, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+		lv_obj_set_flex_flow(row->row, LV_FLEX_FLOW_ROW);
+		lv_obj_set_flex_align(row->row, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER,
+							  LV_FLEX_ALIGN_CENTER);
+		row->icon = lv_image_create(row->row);
+		lv_obj_add_flag(row->icon, LV_OBJ_FLAG_HIDDEN);
+		row->label = lv_label_create(row->row);
+		lv_label_set_long_mode(row->label, LV_LABEL_LONG_DOT);
+		lv_obj_set_flex_grow(row->label, 1);
+	}
+
+	lv_obj_add_event_cb(vlist, vlist_event_cb, LV_EVENT_ALL, ctx);
+	vlist_bind_all(ctx);
+	return vlist;
+}
+
+void esp_menu_vlist_set_count(lv_obj_t *vlist, uint32_t item_count) {
+	vlist_ctx_t *ctx = lv_obj_get_user_data(vlist);
+	if (!ctx) {
+		return;
+	}
+	ctx->cfg.item_count = item_count;
+	ctx->first = 0;
+	vlist_select(ctx, ctx->selected);
+	vlist_bind_all(ctx);
+}
+
+void esp_menu_vlist_refresh(lv_obj_t *vlist) {
+	vlist_ctx_t *ctx = lv_obj_get_user_data(vlist);
+	if (ctx) {
+		vlist_bind_all(ctx);
+	}
+}
+
+void esp_menu_vlist_refresh_item(lv_obj_t *vlist, uint32_t index) {
+	vlist_ctx_t *ctx = lv_obj_get_user_data(vlist);
+	if (ctx && index >= ctx->first && index - ctx->first < ctx->row_count) {
+		vlist_bind_row(ctx, (uint8_t)(index - ctx->first));
+	}
+}
+
+void esp_menu_vlist_set_selected(lv_obj_t *vlist, uint32_t index) {
+	vlist_ctx_t *ctx = lv_obj_get_user_data(vlist);
+	if (ctx) {
+		vlist_select(ctx, index);
+	}
+}
+
+uint32_t esp_menu_vlist_get_selected(lv_obj_t *vlist) {
+	vlist_ctx_t *ctx = lv_obj_get_user_data(vlist);
+	return ctx ? ctx->selected : 0;
+}
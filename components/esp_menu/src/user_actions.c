@@ -2,6 +2,9 @@
 #include "user_actions.h"
 #include "menu_data.h"  // Prototypes for generated menu actions
 #include "esp_log.h"
+#include "esp_menu_engine.h"
+#include "esp_menu_preset.h"
+#include "esp_menu_store.h"
 
 static const char *TAG_ACTIONS = "esp_menu_actions";
 
@@ -13,85 +16,73 @@ void init_menu_params(void) {
 }
 
 esp_err_t user_save_params_to_nvs(void) {
-	// Stub: implement real persistence in application
-	ESP_LOGI(TAG_ACTIONS, "Saving params to NVS (stub)");
-	return ESP_OK;
+	// Menu parameters are written behind by esp_menu_store; this only forces the pending write
+	return esp_menu_store_flush();
 }
 
 esp_err_t user_load_params_from_nvs(void) {
-	// Stub: implement real persistence in application
-	ESP_LOGI(TAG_ACTIONS, "Loading params from NVS (stub)");
-	return ESP_OK;
+	return esp_menu_store_load();
 }
 
 // --- Generated menu action stubs ---
-// Keep simple, non-blocking bodies with logs so link succeeds and behavior is visible.
+// Keep bodies short and non-blocking: they run in the LVGL task.
+// Parameter rows (pitch, waveform, level, ...) need no actions: the engine edits them
+// through the descriptors in menu.json.
 
-void pitch_up(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: pitch_up");
-}
-
-void pitch_down(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: pitch_down");
-}
+#ifdef CONFIG_ESPMENU_FAV_SLOTS
+#define FAV_SLOTS CONFIG_ESPMENU_FAV_SLOTS
+#else
+#define FAV_SLOTS 1
+#endif
 
-void waveform_next(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: waveform_next");
-}
-
-void waveform_prev(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: waveform_prev");
-}
-
-void level_up(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: level_up");
-}
-
-void level_down(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: level_down");
-}
-
-void fine_tune_up(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: fine_tune_up");
-}
-
-void fine_tune_down(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: fine_tune_down");
-}
-
-void pulse_width_up(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: pulse_width_up");
-}
-
-void pulse_width_down(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: pulse_width_down");
-}
-
-void amp_mod_slot_next(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: amp_mod_slot_next");
-}
-
-void amp_mod_slot_prev(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: amp_mod_slot_prev");
-}
+static uint8_t s_fav_slot = 0;  // Slot the save/load/clear rows act on
 
 void select_favorite_slot_next(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: select_favorite_slot_next");
+	s_fav_slot = (uint8_t)((s_fav_slot + 1) % FAV_SLOTS);
+	ESP_LOGI(TAG_ACTIONS, "Favorite slot %u%s", (unsigned)s_fav_slot,
+	         esp_menu_store_fav_used(s_fav_slot) ? "" : " (empty)");
 }
 
 void select_favorite_slot_prev(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: select_favorite_slot_prev");
+	s_fav_slot = (uint8_t)((s_fav_slot + FAV_SLOTS - 1) % FAV_SLOTS);
+	ESP_LOGI(TAG_ACTIONS, "Favorite slot %u%s", (unsigned)s_fav_slot,
+	         esp_menu_store_fav_used(s_fav_slot) ? "" : " (empty)");
 }
 
 void save_favorite_action(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: save_favorite_action");
+	esp_err_t err = esp_menu_store_fav_save(s_fav_slot);
+	if (err != ESP_OK) {
+		ESP_LOGW(TAG_ACTIONS, "Save favorite %u: %s", (unsigned)s_fav_slot, esp_err_to_name(err));
+	}
 }
 
 void load_favorite_action(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: load_favorite_action");
+	esp_err_t err = esp_menu_store_fav_load(s_fav_slot);
+	if (err != ESP_OK) {
+		ESP_LOGW(TAG_ACTIONS, "Load favorite %u: %s", (unsigned)s_fav_slot, esp_err_to_name(err));
+		return;
+	}
+	// Actions run in the LVGL task, so the visible rows can be redrawn directly
+	esp_menu_engine_refresh();
 }
 
 void clear_favorite_action(void) {
-	ESP_LOGI(TAG_ACTIONS, "Action: clear_favorite_action");
+	esp_err_t err = esp_menu_store_fav_clear(s_fav_slot);
+	if (err != ESP_OK) {
+		ESP_LOGW(TAG_ACTIONS, "Clear favorite %u: %s", (unsigned)s_fav_slot, esp_err_to_name(err));
+	}
 }
 
+void preset_load_action(void) {
+	esp_err_t err = esp_menu_preset_browser_open(ESP_MENU_PRESET_BROWSE_LOAD);
+	if (err != ESP_OK) {
+		ESP_LOGW(TAG_ACTIONS, "Preset browser: %s", esp_err_to_name(err));
+	}
+}
+
+void preset_save_action(void) {
+	esp_err_t err = esp_menu_preset_browser_open(ESP_MENU_PRESET_BROWSE_SAVE);
+	if (err != ESP_OK) {
+		ESP_LOGW(TAG_ACTIONS, "Preset browser: %s", esp_err_to_name(err));
+	}
+}
@@ -0,0 +1,94 @@
+// Unity tests for the esp_menu display page conversion
+#include "unity.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_menu_display.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_HRES 128
+#define BENCH_VRES 64
+#define BENCH_STRIDE (BENCH_HRES / 8)
+#define BENCH_FRAMES 32
+
+/* Per-pixel conversion as done by esp_lvgl_port for monochrome displays */
+static void convert_per_pixel(const uint8_t *px, uint8_t *out)
+{
+	for (int y = 0; y < BENCH_VRES; y++) {
+		for (int x = 0; x < BENCH_HRES; x++) {
+			uint8_t *dst = &out[BENCH_HRES * (y / 8) + x];
+			if (px[y * BENCH_STRIDE + x / 8] & (1 << (7 - (x % 8)))) {
+				*dst &= ~(1 << (y % 8));
+			} else {
+				*dst |= (1 << (y % 8));
+			}
+		}
+	}
+}
+
+static void convert_tiles(const uint8_t *px, uint8_t *out)
+{
+	for (int page = 0; page < BENCH_VRES / 8; page++) {
+		esp_menu_display_pack_page(&px[page * 8 * BENCH_STRIDE], BENCH_STRIDE, BENCH_HRES,
+								   &out[page * BENCH_HRES]);
+	}
+}
+
+TEST_CASE("display page packing matches per-pixel conversion", "[esp_menu][display]")
+{
+	uint8_t *px = malloc(BENCH_STRIDE * BENCH_VRES);
+	uint8_t *ref = calloc(1, BENCH_HRES * BENCH_VRES / 8);
+	uint8_t *out = calloc(1, BENCH_HRES * BENCH_VRES / 8);
+	TEST_ASSERT_NOT_NULL(px);
+	TEST_ASSERT_NOT_NULL(ref);
+	TEST_ASSERT_NOT_NULL(out);
+
+	srand(1);
+	for (int i = 0; i < BENCH_STRIDE * BENCH_VRES; i++) {
+		px[i] = rand();
+	}
+	convert_per_pixel(px, ref);
+	convert_tiles(px, out);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(ref, out, BENCH_HRES * BENCH_VRES / 8);
+
+	/* A width that is not a whole number of tiles leaves the rest untouched */
+	memset(out, 0x5A, BENCH_HRES);
+	esp_menu_display_pack_page(px, BENCH_STRIDE, 13, out);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(ref, out, 13);
+	TEST_ASSERT_EQUAL_HEX8(0x5A, out[13]);
+
+	free(px);
+	free(ref);
+	free(out);
+}
+
+TEST_CASE("display page packing benchmark", "[esp_menu][display][benchmark]")
+{
+	uint8_t *px = malloc(BENCH_STRIDE * BENCH_VRES);
+	uint8_t *out = heap_caps_calloc(1, BENCH_HRES * BENCH_VRES / 8, MALLOC_CAP_DMA);
+	TEST_ASSERT_NOT_NULL(px);
+	TEST_ASSERT_NOT_NULL(out);
+	for (int i = 0; i < BENCH_STRIDE * BENCH_VRES; i++) {
+		px[i] = i * 37;
+	}
+
+	uint32_t start = esp_cpu_get_cycle_count();
+	for (int i = 0; i < BENCH_FRAMES; i++) {
+		convert_per_pixel(px, out);
+	}
+	uint32_t per_pixel = (esp_cpu_get_cycle_count() - start) / BENCH_FRAMES;
+
+	start = esp_cpu_get_cycle_count();
+	for (int i = 0; i < BENCH_FRAMES; i++) {
+		convert_tiles(px, out);
+	}
+	uint32_t tiles = (esp_cpu_get_cycle_count() - start) / BENCH_FRAMES;
+
+	printf("%dx%d frame: per-pixel %lu cycles, 8x8 tiles %lu cycles\n", BENCH_HRES, BENCH_VRES,
+		   (unsigned long)per_pixel, (unsigned long)tiles);
+	TEST_ASSERT_LESS_THAN_UINT32(per_pixel, tiles);
+
+	free(px);
+	heap_caps_free(out);
+}
@@ -0,0 +1,235 @@
+// Unity tests for the esp_menu parameter record (CONFIG_ESPMENU_STORE_BLOB)
+#include "unity.h"
+#include "esp_menu_param.h"
+#include "esp_menu_store.h"
+#include "esp_rom_crc.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "sdkconfig.h"
+#include <stddef.h>
+#include <string.h>
+
+#if defined(CONFIG_ESPMENU_ENABLE_NVS) && defined(CONFIG_ESPMENU_STORE_BLOB)
+
+/* Record layout written by esp_menu_store.c; these tests pin it down */
+#define RECORD_KEY "params"
+#define RECORD_MAGIC 0x554E4D45u
+#define RECORD_VERSION 1
+
+typedef struct __attribute__((packed)) {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t count;
+	uint32_t crc;
+} record_header_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t key_hash;
+	int32_t value;
+} record_entry_t;
+
+enum { P_GAIN, P_MODE, P_LEVEL, P_SCRATCH, P_COUNT };
+
+static const esp_menu_param_desc_t s_descs[P_COUNT] = {
+	[P_GAIN] = {.label = "Gain", .nvs_key = "t_gain", .type = ESP_MENU_PARAM_I32,
+				.min = 0, .max = 1000, .step = 1, .def = 10},
+	[P_MODE] = {.label = "Mode", .nvs_key = "t_mode", .type = ESP_MENU_PARAM_U8,
+				.min = 0, .max = 3, .step = 1, .def = 1},
+	[P_LEVEL] = {.label = "Level", .nvs_key = "t_level", .type = ESP_MENU_PARAM_I16,
+				 .min = -50, .max = 50, .step = 1, .def = 0},
+	/* Not persisted: never part of the record */
+	[P_SCRATCH] = {.label = "Scratch", .type = ESP_MENU_PARAM_U8,
+				   .min = 0, .max = 9, .step = 1, .def = 5},
+};
+static int32_t s_values[P_COUNT];
+static const esp_menu_param_table_t s_table = {s_descs, s_values, P_COUNT};
+
+/* Stop the store, empty its namespace and start again from the defaults */
+static void store_test_begin(void)
+{
+	esp_menu_store_deinit();
+	esp_err_t err = nvs_flash_init();
+	if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+		TEST_ESP_OK(nvs_flash_erase());
+		err = nvs_flash_init();
+	}
+	TEST_ESP_OK(err);
+	nvs_handle_t nvs;
+	TEST_ESP_OK(nvs_open(CONFIG_ESPMENU_NVS_NAMESPACE, NVS_READWRITE, &nvs));
+	TEST_ESP_OK(nvs_erase_all(nvs));
+	TEST_ESP_OK(nvs_commit(nvs));
+	nvs_close(nvs);
+	TEST_ESP_OK(esp_menu_param_register(&s_table));
+}
+
+static uint32_t record_crc(const record_header_t *hdr, const record_entry_t *entries)
+{
+	uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)hdr, offsetof(record_header_t, crc));
+	return esp_rom_crc32_le(crc, (const uint8_t *)entries, hdr->count * sizeof(record_entry_t));
+}
+
+static void record_write(const record_entry_t *entries, uint16_t count, uint32_t crc_xor)
+{
+	uint8_t buf[sizeof(record_header_t) + 8 * sizeof(record_entry_t)];
+	TEST_ASSERT_LESS_OR_EQUAL(8, count);
+	record_header_t *hdr = (record_header_t *)buf;
+	hdr->magic = RECORD_MAGIC;
+	hdr->version = RECORD_VERSION;
+	hdr->count = count;
+	memcpy(hdr + 1, entries, count * sizeof(record_entry_t));
+	hdr->crc = record_crc(hdr, (const record_entry_t *)(hdr + 1)) ^ crc_xor;
+
+	nvs_handle_t nvs;
+	TEST_ESP_OK(nvs_open(CONFIG_ESPMENU_NVS_NAMESPACE, NVS_READWRITE, &nvs));
+	TEST_ESP_OK(nvs_set_blob(nvs, RECORD_KEY, buf, sizeof(*hdr) + count * sizeof(record_entry_t)));
+	TEST_ESP_OK(nvs_commit(nvs));
+	nvs_close(nvs);
+}
+
+/* Read the record back and check its header and CRC; returns the entry count */
+static uint16_t record_read(record_entry_t *entries, uint16_t max)
+{
+	uint8_t buf[sizeof(record_header_t) + 8 * sizeof(record_entry_t)];
+	size_t len = sizeof(buf);
+	nvs_handle_t nvs;
+	TEST_ESP_OK(nvs_open(CONFIG_ESPMENU_NVS_NAMESPACE, NVS_READONLY, &nvs));
+	TEST_ESP_OK(nvs_get_blob(nvs, RECORD_KEY, buf, &len));
+	nvs_close(nvs);
+
+	const record_header_t *hdr = (const record_header_t *)buf;
+	TEST_ASSERT_EQUAL_HEX32(RECORD_MAGIC, hdr->magic);
+	TEST_ASSERT_EQUAL_UINT16(RECORD_VERSION, hdr->version);
+	TEST_ASSERT_LESS_OR_EQUAL(max, hdr->count);
+	TEST_ASSERT_EQUAL(sizeof(*hdr) + hdr->count * sizeof(record_entry_t), len);
+	TEST_ASSERT_EQUAL_HEX32(record_crc(hdr, (const record_entry_t *)(hdr + 1)), hdr->crc);
+	memcpy(entries, hdr + 1, hdr->count * sizeof(record_entry_t));
+	return hdr->count;
+}
+
+static int32_t record_value(const record_entry_t *entries, uint16_t count, uint16_t id)
+{
+	for (uint16_t i = 0; i < count; i++) {
+		if (entries[i].key_hash == esp_menu_param_key_hash(id)) {
+			return entries[i].value;
+		}
+	}
+	TEST_FAIL_MESSAGE("parameter missing from the record");
+	return 0;
+}
+
+TEST_CASE("store record round-trips every persisted parameter", "[esp_menu][store]")
+{
+	store_test_begin();
+	TEST_ESP_OK(esp_menu_store_init());
+	TEST_ESP_OK(esp_menu_param_set(P_GAIN, 321));
+	TEST_ESP_OK(esp_menu_param_set(P_MODE, 3));
+	TEST_ESP_OK(esp_menu_param_set(P_LEVEL, -42));
+	TEST_ESP_OK(esp_menu_param_set(P_SCRATCH, 9));
+	TEST_ESP_OK(esp_menu_store_sync());
+	esp_menu_store_deinit();
+
+	record_entry_t entries[8];
+	uint16_t count = record_read(entries, 8);
+	TEST_ASSERT_EQUAL_UINT16(3, count);
+	TEST_ASSERT_EQUAL_INT32(321, record_value(entries, count, P_GAIN));
+	TEST_ASSERT_EQUAL_INT32(3, record_value(entries, count, P_MODE));
+	TEST_ASSERT_EQUAL_INT32(-42, record_value(entries, count, P_LEVEL));
+
+	esp_menu_param_reset_defaults();
+	TEST_ESP_OK(esp_menu_store_init());
+	TEST_ASSERT_EQUAL_INT32(321, esp_menu_param_get(P_GAIN));
+	TEST_ASSERT_EQUAL_INT32(3, esp_menu_param_get(P_MODE));
+	TEST_ASSERT_EQUAL_INT32(-42, esp_menu_param_get(P_LEVEL));
+	TEST_ASSERT_EQUAL_INT32(5, esp_menu_param_get(P_SCRATCH));
+	esp_menu_store_deinit();
+}
+
+TEST_CASE("store record with a bad CRC falls back to the defaults", "[esp_menu][store]")
+{
+	store_test_begin();
+	const record_entry_t entries[] = {
+		{esp_menu_param_key_hash(P_GAIN), 777},
+		{esp_menu_param_key_hash(P_MODE), 2},
+		{esp_menu_param_key_hash(P_LEVEL), 7},
+	};
+	record_write(entries, 3, 0x1);
+	/* Values left over from before must not survive a torn record either */
+	TEST_ESP_OK(esp_menu_param_set(P_GAIN, 500));
+	TEST_ESP_OK(esp_menu_param_set(P_LEVEL, 20));
+
+	TEST_ESP_OK(esp_menu_store_init());
+	TEST_ASSERT_EQUAL_INT32(10, esp_menu_param_get(P_GAIN));
+	TEST_ASSERT_EQUAL_INT32(1, esp_menu_param_get(P_MODE));
+	TEST_ASSERT_EQUAL_INT32(0, esp_menu_param_get(P_LEVEL));
+
+	/* The record is rewritten from the defaults */
+	TEST_ESP_OK(esp_menu_store_sync());
+	esp_menu_store_deinit();
+	record_entry_t read[8];
+	uint16_t count = record_read(read, 8);
+	TEST_ASSERT_EQUAL_INT32(10, record_value(read, count, P_GAIN));
+}
+
+TEST_CASE("store record keeps values past unknown and missing keys", "[esp_menu][store]")
+{
+	store_test_begin();
+	/* Saved by a menu that had a parameter since removed and no Mode yet */
+	const record_entry_t entries[] = {
+		{0x12345678u, 99},
+		{esp_menu_param_key_hash(P_LEVEL), -7},
+		{esp_menu_param_key_hash(P_GAIN), 640},
+	};
+	TEST_ASSERT_NOT_EQUAL(esp_menu_param_key_hash(P_GAIN), 0x12345678u);
+	record_write(entries, 3, 0);
+
+	TEST_ESP_OK(esp_menu_store_init());
+	TEST_ASSERT_EQUAL_INT32(640, esp_menu_param_get(P_GAIN));
+	TEST_ASSERT_EQUAL_INT32(-7, esp_menu_param_get(P_LEVEL));
+	TEST_ASSERT_EQUAL_INT32(1, esp_menu_param_get(P_MODE));
+
+	/* Rewritten to match the current parameters: unknown key dropped, Mode added */
+	TEST_ESP_OK(esp_menu_store_sync());
+	esp_menu_store_deinit();
+	record_entry_t read[8];
+	uint16_t count = record_read(read, 8);
+	TEST_ASSERT_EQUAL_UINT16(3, count);
+	TEST_ASSERT_EQUAL_INT32(1, record_value(read, count, P_MODE));
+	TEST_ASSERT_EQUAL_INT32(640, record_value(read, count, P_GAIN));
+}
+
+TEST_CASE("store record migrates values saved one key at a time", "[esp_menu][store]")
+{
+	store_test_begin();
+	nvs_handle_t nvs;
+	TEST_ESP_OK(nvs_open(CONFIG_ESPMENU_NVS_NAMESPACE, NVS_READWRITE, &nvs));
+	TEST_ESP_OK(nvs_set_i32(nvs, "t_gain", 123));
+	TEST_ESP_OK(nvs_set_i16(nvs, "t_level", -3));
+	TEST_ESP_OK(nvs_commit(nvs));
+	nvs_close(nvs);
+
+	TEST_ESP_OK(esp_menu_store_init());
+	TEST_ASSERT_EQUAL_INT32(123, esp_menu_param_get(P_GAIN));
+	TEST_ASSERT_EQUAL_INT32(-3, esp_menu_param_get(P_LEVEL));
+	TEST_ASSERT_EQUAL_INT32(1, esp_menu_param_get(P_MODE));
+	TEST_ESP_OK(esp_menu_store_sync());
+	esp_menu_store_deinit();
+
+	record_entry_t read[8];
+	uint16_t count = record_read(read, 8);
+	TEST_ASSERT_EQUAL_UINT16(3, count);
+	TEST_ASSERT_EQUAL_INT32(123, record_value(read, count, P_GAIN));
+	TEST_ASSERT_EQUAL_INT32(-3, record_value(read, count, P_LEVEL));
+	TEST_ASSERT_EQUAL_INT32(1, record_value(read, count, P_MODE));
+
+	/* Once migrated, the record wins over the old per-key entries */
+	TEST_ESP_OK(nvs_open(CONFIG_ESPMENU_NVS_NAMESPACE, NVS_READWRITE, &nvs));
+	TEST_ESP_OK(nvs_set_i32(nvs, "t_gain", 999));
+	TEST_ESP_OK(nvs_commit(nvs));
+	nvs_close(nvs);
+	esp_menu_param_reset_defaults();
+	TEST_ESP_OK(esp_menu_store_init());
+	TEST_ASSERT_EQUAL_INT32(123, esp_menu_param_get(P_GAIN));
+	esp_menu_store_deinit();
+}
+
+#endif  // CONFIG_ESPMENU_ENABLE_NVS && CONFIG_ESPMENU_STORE_BLOB
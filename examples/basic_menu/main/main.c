@@ -11,6 +11,7 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_menu.h"
+#include "esp_menu_store.h"
 // #include "menu_data.h" // Contains prototypes for menu actions - commented out for simple menu
 #include "user_actions.h" // Contains prototypes for user actions
 #include "sdkconfig.h"
@@ -49,8 +50,20 @@ void app_main(void)
         sleep(5); // Sleep for 5 seconds between heartbeats
 
 #ifdef CONFIG_ESPMENU_ENABLE_NVS
-        // Optional: Save menu state periodically
-        user_save_params_to_nvs();
+#ifndef CONFIG_ESPMENU_AUTO_SAVE
+        // Without auto-save, edits stay in RAM until flushed; only changed keys are written
+        esp_err_t flush_err = esp_menu_store_flush();
+        if (flush_err != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Parameter flush failed: %s", esp_err_to_name(flush_err));
+        }
+#endif
+        // With auto-save the store writes changed parameters once edits settle
+        esp_menu_store_stats_t stats;
+        esp_menu_store_get_stats(&stats);
+        ESP_LOGI(TAG, "NVS: %lu commits, %lu keys written, %lu unchanged skipped",
+                 (unsigned long)stats.commits, (unsigned long)stats.keys_written,
+                 (unsigned long)stats.writes_skipped);
 #endif
     }
 }
\ No newline at end of file
@@ -39,11 +39,6 @@ typedef struct
  */
 extern menu_params_t menu_params;
 
-/**
- * @brief Current favorite slot index
- */
-extern uint8_t current_slot;
-
 /**
  * @brief Initialize menu parameters with default values
  */
@@ -4,6 +4,7 @@ Script to generate menu.c and menu_data.h from Jinja2 templates and menu.json.
 """
 
 import os
+import re
 import sys
 import json
 import jinja2
@@ -85,7 +86,9 @@ def render_template(template_path, output_path, context):
         os.makedirs(os.path.dirname(output_path), exist_ok=True)
         template_dir = os.path.dirname(template_path)
         template_file = os.path.basename(template_path)
-        env = jinja2.Environment(loader=jinja2.FileSystemLoader(template_dir))
+        env = jinja2.Environment(loader=jinja2.FileSystemLoader(template_dir),
+                                 trim_blocks=True, lstrip_blocks=True)
+        env.filters['c_ident'] = c_ident
         template = env.get_template(template_file)
 
         # Debug context variables
@@ -125,17 +128,243 @@ LV_IMG_DECLARE({graphic['id']}_dsc);
 
 def extract_action_prototypes(config):
     actions = set()
+
+    def collect(items):
+        for item in items:
+            if 'callback' in item and item['callback']:
+                actions.add(item['callback'])
+            if item.get('type') == 'submenu':
+                collect(item.get('items', []))
+
     if 'menu' in config and 'screens' in config['menu']:
         for screen in config['menu']['screens']:
-            if 'items' in screen:
-                for item in screen['items']:
-                    if 'callback' in item and item['callback']:
-                        actions.add(item['callback'])
-                    if item.get('type') == 'submenu' and 'items' in item:
-                        for subitem in item['items']:
-                            if 'callback' in subitem and subitem['callback']:
-                                actions.add(subitem['callback'])
-    return [f"void {action}(void);" for action in sorted(actions)]
+            collect(screen.get('items', []))
+    prototypes = [f"void {action}(void);" for action in sorted(actions)]
+    on_change = sorted({param['callback'] for param in config.get('params', []) if param.get('callback')})
+    prototypes += [f"void {callback}(int32_t value);" for callback in on_change]
+    return prototypes
+
+
+def c_ident(name):
+    """Mirror of the template's ident() macro: turn a label into a C identifier."""
+    ident = name.replace(' ', '_').replace('/', '_').replace('-', '_').replace('&', 'and').lower()
+    return re.sub(r'[^0-9a-z_]', '', ident)
+
+
+# Value range of each parameter storage type
+PARAM_TYPE_RANGES = {
+    'u8': (0, 0xFF),
+    'i8': (-0x80, 0x7F),
+    'u16': (0, 0xFFFF),
+    'i16': (-0x8000, 0x7FFF),
+    'i32': (-0x80000000, 0x7FFFFFFF),
+    'bool': (0, 1),
+    'enum': (0, 0xFF),
+}
+
+
+def nvs_key_hash(key):
+    """FNV-1a of an NVS key, as computed by esp_menu_param_key_hash() (never 0)."""
+    value = 2166136261
+    for byte in key.encode():
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value or 1
+
+
+def build_param_table(config):
+    """
+    Validate the 'params' array of menu.json and build the descriptor table.
+
+    Each parameter gets a MENU_PARAM_<NAME> ID equal to its index. Enum
+    parameters take their range from their options; bool parameters wrap
+    between Off and On. Ranges, steps and defaults are checked against the
+    storage type here so the runtime editor never has to.
+    """
+    params = []
+    for param in config.get('params', []):
+        name = param.get('name')
+        kind = param.get('type', 'i32')
+        if not name or kind not in PARAM_TYPE_RANGES:
+            logger.error(f"Parameter {name!r} has missing name or unknown type {kind!r}")
+            sys.exit(1)
+        lo, hi = PARAM_TYPE_RANGES[kind]
+        options = param.get('options', [])
+        wrap = param.get('wrap', False)
+        if kind == 'enum':
+            if not options:
+                logger.error(f"Enum parameter '{name}' needs options")
+                sys.exit(1)
+            pmin, pmax, step = 0, len(options) - 1, 1
+        elif kind == 'bool':
+            pmin, pmax, step, wrap = 0, 1, 1, True
+        else:
+            pmin, pmax, step = param.get('min', lo), param.get('max', hi), param.get('step', 1)
+        default = param.get('default', pmin)
+        accel = param.get('accel', 'none' if kind in ('enum', 'bool') else 'quadratic')
+        accel_max = param.get('accel_max', 0)
+        if accel not in ('none', 'linear', 'quadratic') or not 0 <= accel_max <= 0xFFFF:
+            logger.error(f"Parameter '{name}': invalid accel {accel!r} or accel_max {accel_max}")
+            sys.exit(1)
+        if not (lo <= pmin <= default <= pmax <= hi) or step <= 0:
+            logger.error(f"Parameter '{name}': range {pmin}..{pmax}, default {default} "
+                         f"or step {step} invalid for type {kind}")
+            sys.exit(1)
+        if param.get('nvs_key') and len(param['nvs_key']) > 15:
+            logger.error(f"NVS key '{param['nvs_key']}' of '{name}' exceeds 15 characters")
+            sys.exit(1)
+        ident = c_ident(name)
+        params.append({
+            'id': len(params),
+            'enum': f"MENU_PARAM_{ident.upper()}",
+            'ident': ident,
+            'label': json.dumps(param.get('label', name), ensure_ascii=False),
+            'type': 'ESP_MENU_PARAM_' + kind.upper(),
+            'min': pmin,
+            'max': pmax,
+            'step': step,
+            'default': default,
+            'flags': 'ESP_MENU_PARAM_FLAG_WRAP' if wrap else '0',
+            'accel': 'ESP_MENU_ACCEL_' + accel.upper(),
+            'accel_max': accel_max,
+            'nvs_key': json.dumps(param['nvs_key']) if param.get('nvs_key') else 'NULL',
+            'format': json.dumps(param['format']) if param.get('format') else 'NULL',
+            'options': [json.dumps(option, ensure_ascii=False) for option in options],
+            'callback': param.get('callback') or 'NULL',
+        })
+
+    seen = set()
+    for param in params:
+        if param['enum'] in seen:
+            logger.error(f"Duplicate parameter identifier {param['enum']}")
+            sys.exit(1)
+        seen.add(param['enum'])
+
+    # Stored values are matched to parameters by key hash, so keys and hashes must be unique
+    keys = {}
+    hashes = {}
+    for param in config.get('params', []):
+        key = param.get('nvs_key')
+        if not key:
+            continue
+        if key in keys:
+            logger.error(f"Duplicate NVS key '{key}' in '{keys[key]}' and '{param['name']}'")
+            sys.exit(1)
+        keys[key] = param['name']
+        key_hash = nvs_key_hash(key)
+        if key_hash in hashes:
+            logger.error(f"NVS keys '{hashes[key_hash]}' and '{key}' have the same hash "
+                         f"0x{key_hash:08x}; rename one")
+            sys.exit(1)
+        hashes[key_hash] = key
+    logger.debug(f"Parameters: {len(params)}")
+    return params
+
+
+# Encoders 2-4 can be direct controls; encoder 1 always drives navigation
+DIRECT_ENCODER_MAX = 3
+
+
+def build_direct_bindings(config, params):
+    """
+    Resolve the bindings of the direct-control encoders (encoders 2-4).
+
+    An encoder entry may name a parameter with 'param', or set 'follow' (the
+    default) to control the n-th parameter row of whatever screen is shown;
+    'follow': false leaves it unbound.
+    """
+    known = {p['enum'] for p in params}
+    encoders = config.get('encoders', [])
+    if encoders and encoders[0].get('param'):
+        logger.warning("Encoder 1 drives menu navigation; its 'param' binding is ignored")
+    bindings = []
+    for index in range(DIRECT_ENCODER_MAX):
+        entry = encoders[index + 1] if index + 1 < len(encoders) else {}
+        if entry.get('param'):
+            binding = f"MENU_PARAM_{c_ident(entry['param']).upper()}"
+            if binding not in known:
+                logger.error(f"Encoder {index + 2} refers to unknown parameter {entry['param']!r}")
+                sys.exit(1)
+        elif entry.get('follow', True):
+            binding = 'ESP_MENU_DIRECT_FOLLOW'
+        else:
+            binding = 'ESP_MENU_NO_PARAM'
+        bindings.append(binding)
+    return bindings
+
+
+def build_menu_tree(config, params):
+    """
+    Flatten menu.json into the screen and item tables consumed by the runtime engine.
+
+    Submenus may nest to any depth. Screens are numbered breadth-first: screen 0
+    is the root and collects the items of every top-level screen, and each
+    submenu becomes a screen when its parent is processed. Every item gets a
+    stable numeric ID equal to its index in the item table, so IDs only change
+    when the JSON itself is reordered. Each screen owns a contiguous range of
+    items. Param items bind their row to an entry of the parameter table
+    instead of a callback. The deepest screen's level is returned as max_depth
+    (root = 1) and bounds the runtime navigation stack.
+    """
+    screens = [{
+        'name': 'main',
+        'enum': 'MENU_SCREEN_MAIN',
+        'depth': 1,
+        'items': [(item, screen.get('name', 'main'))
+                  for screen in config['menu']['screens']
+                  for item in screen.get('items', [])],
+    }]
+
+    items = []
+    index = 0
+    while index < len(screens):
+        screen = screens[index]
+        screen['first_item'] = len(items)
+        for item, owner in screen['items']:
+            kind = item.get('type', 'action')
+            if kind not in ('action', 'submenu', 'param'):
+                logger.warning(f"Unknown item type '{kind}' for '{item['name']}', treating as action")
+                kind = 'action'
+            child_screen = 'ESP_MENU_NO_SCREEN'
+            param = 'ESP_MENU_NO_PARAM'
+            if kind == 'param':
+                param = f"MENU_PARAM_{c_ident(item.get('param', '')).upper()}"
+                if param not in {p['enum'] for p in params}:
+                    logger.error(f"Item '{item['name']}' refers to unknown parameter {item.get('param')!r}")
+                    sys.exit(1)
+            if kind == 'submenu':
+                child_screen = f"MENU_SCREEN_{c_ident(item['name']).upper()}"
+                screens.append({
+                    'name': item['name'],
+                    'enum': child_screen,
+                    'depth': screen['depth'] + 1,
+                    'items': [(subitem, item['name']) for subitem in item.get('items', [])],
+                })
+            items.append({
+                'id': len(items),
+                'enum': f"MENU_ITEM_{c_ident(owner).upper()}_{c_ident(item['name']).upper()}",
+                'name': item['name'],
+                'label': json.dumps(item['name'], ensure_ascii=False),
+                'type': 'ESP_MENU_ITEM_' + kind.upper(),
+                'icon': f"&{item['graphic_id']}_dsc" if item.get('graphic_id') else 'NULL',
+                'callback': item.get('callback') if kind == 'action' and item.get('callback') else 'NULL',
+                'child_screen': child_screen,
+                'param': param,
+            })
+        screen['item_count'] = len(items) - screen['first_item']
+        del screen['items']
+        index += 1
+
+    for table, what in ((items, 'menu item'), (screens, 'screen')):
+        seen = set()
+        for entry in table:
+            if entry['enum'] in seen:
+                logger.error(f"Duplicate {what} identifier {entry['enum']}")
+                sys.exit(1)
+            seen.add(entry['enum'])
+
+    max_depth = max(screen['depth'] for screen in screens)
+    logger.debug(f"Menu tree: {len(screens)} screens, {len(items)} items, depth {max_depth}")
+    return screens, items, max_depth
 
 
 def main():
@@ -156,6 +385,9 @@ def main():
     config = adapt_json_structure(config)
     graphics_code = process_graphics_code(config)
     action_prototypes = extract_action_prototypes(config)
+    menu_params = build_param_table(config)
+    menu_screens, menu_items, menu_max_depth = build_menu_tree(config, menu_params)
+    direct_bindings = build_direct_bindings(config, menu_params)
 
     logger.debug(f"Graphics code type: {type(graphics_code)}")
     logger.debug(f"Graphics code content: {graphics_code}")
@@ -164,7 +396,12 @@ def main():
     context = {
         'config': config,
         'graphics_code': graphics_code,
-        'action_prototypes': action_prototypes
+        'action_prototypes': action_prototypes,
+        'menu_screens': menu_screens,
+        'menu_items': menu_items,
+        'menu_max_depth': menu_max_depth,
+        'menu_params': menu_params,
+        'direct_bindings': direct_bindings
     }
 
     menu_c_template = os.path.join(templates_dir, "menu.c.j2")
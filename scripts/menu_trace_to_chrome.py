@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""
+Extract an esp_menu "menu_trace" dump from a serial log into a Chrome
+trace-event file for chrome://tracing or https://ui.perfetto.dev.
+
+The device prints one event per line, but log output from other tasks may
+land in the middle of the dump; such lines are dropped. Prints the longest
+spans per activity so stalls show up without opening the viewer.
+"""
+
+import argparse
+import json
+import logging
+import re
+import sys
+
+# Configure logging
+logging.basicConfig(level=logging.INFO,
+                    format='%(levelname)s - %(message)s')
+logger = logging.getLogger(__name__)
+
+DUMP_START = '{"displayTimeUnit":'
+DUMP_END = ']}'
+ANSI_ESCAPE = re.compile(r'\x1b\[[0-9;]*[A-Za-z]')
+
+
+def find_dumps(lines):
+    """Return the event lines of every dump in the log, oldest first."""
+    dumps = []
+    current = None
+    for raw in lines:
+        line = ANSI_ESCAPE.sub('', raw).strip()
+        if DUMP_START in line:
+            current = []
+            dumps.append(current)
+            continue
+        if current is None:
+            continue
+        if line.startswith(DUMP_END):
+            current = None
+            continue
+        current.append(line)
+    return dumps
+
+
+def parse_events(lines):
+    events = []
+    dropped = 0
+    for line in lines:
+        try:
+            event = json.loads(line.rstrip(','))
+        except json.JSONDecodeError:
+            dropped += 1
+            continue
+        if not isinstance(event, dict) or 'ph' not in event:
+            dropped += 1
+            continue
+        events.append(event)
+    return events, dropped
+
+
+def longest_spans(events, count):
+    """Pair begin and end events per task and return the longest spans per activity."""
+    stacks = {}
+    spans = {}
+    for event in sorted((e for e in events if e['ph'] in 'BE'), key=lambda e: e['ts']):
+        stack = stacks.setdefault(event['tid'], [])
+        if event['ph'] == 'B':
+            stack.append(event)
+            continue
+        # Unmatched ends come from begins overwritten in the ring
+        while stack and stack[-1]['name'] != event['name']:
+            stack.pop()
+        if not stack:
+            continue
+        begin = stack.pop()
+        spans.setdefault(event['name'], []).append((event['ts'] - begin['ts'], begin))
+    return {name: sorted(found, key=lambda s: s[0], reverse=True)[:count]
+            for name, found in spans.items()}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('log', nargs='?', default='-',
+                        help='serial log with a "menu_trace" dump, - for stdin (default)')
+    parser.add_argument('-o', '--output', default='trace.json',
+                        help='trace file to write (default: trace.json)')
+    parser.add_argument('-n', '--dump', type=int, default=-1,
+                        help='which dump of the log to convert, 0 first, -1 last (default)')
+    parser.add_argument('-t', '--top', type=int, default=3,
+                        help='longest spans to print per activity, 0 for none (default: 3)')
+    args = parser.parse_args()
+
+    if args.log == '-':
+        lines = sys.stdin.readlines()
+    else:
+        with open(args.log, 'r', errors='replace') as f:
+            lines = f.readlines()
+
+    dumps = find_dumps(lines)
+    if not dumps:
+        logger.error("No menu_trace dump found")
+        sys.exit(1)
+    try:
+        dump = dumps[args.dump]
+    except IndexError:
+        logger.error(f"Log holds {len(dumps)} dump(s), no dump {args.dump}")
+        sys.exit(1)
+
+    events, dropped = parse_events(dump)
+    if dropped:
+        logger.warning(f"Dropped {dropped} line(s) mixed with other output")
+    # Metadata first, then in time order across both cores
+    events.sort(key=lambda e: (e['ph'] != 'M', e.get('ts', 0)))
+    with open(args.output, 'w') as f:
+        json.dump({'displayTimeUnit': 'ms', 'traceEvents': events}, f, indent=0)
+    logger.info(f"Wrote {len(events)} events to {args.output}")
+
+    if args.top > 0:
+        names = {e['tid']: e['args']['name'] for e in events if e['ph'] == 'M'}
+        for name, spans in sorted(longest_spans(events, args.top).items()):
+            for duration, begin in spans:
+                task = names.get(begin['tid'], begin['tid'])
+                print(f"{name:<10} {duration:>8} us  at {begin['ts']} us  "
+                      f"task {task}, core {begin['args']['core']}")
+
+
+if __name__ == "__main__":
+    main()